@@ -0,0 +1,153 @@
+#pragma once
+
+#include "order.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace lob {
+
+// Compact order layout, measured against the engine's Order by the
+// queue_depth benchmark. It is a benchmark prototype: no book or engine
+// configuration uses it. Orders are addressed by 32-bit pool indices
+// instead of pointers, and the fields the match loop walks (remaining
+// quantity and queue links) live in a tight array of their own, four
+// orders per cache line. Ids, prices and timestamps sit in a separate
+// cold array that is only read when an order is added or reported.
+using OrderHandle = uint32_t;
+constexpr OrderHandle NULL_HANDLE = ~0u;
+
+// Hot fields - 16 bytes
+struct OrderHot {
+    uint32_t remaining_quantity;
+    OrderHandle next;
+    OrderHandle prev;
+    uint32_t level;  // Index of the parent CompactLevel
+};
+
+static_assert(sizeof(OrderHot) == 16, "OrderHot must stay 16 bytes");
+
+// Cold metadata - 32 bytes
+struct OrderCold {
+    uint64_t order_id;
+    uint64_t timestamp;
+    uint32_t price;
+    uint32_t quantity;
+    Side side;
+    OrderType type;
+};
+
+// FIFO queue of orders at one price, linked through OrderHot handles
+struct CompactLevel {
+    uint32_t price = 0;
+    uint32_t total_volume = 0;
+    uint32_t order_count = 0;
+    OrderHandle head = NULL_HANDLE;
+    OrderHandle tail = NULL_HANDLE;
+};
+
+// Split hot/cold order storage with a LIFO free list threaded through
+// OrderHot::next
+class CompactOrderStore {
+public:
+    explicit CompactOrderStore(size_t capacity)
+        : hot_(capacity), cold_(capacity), free_head_(NULL_HANDLE) {
+        // Chain every slot onto the free list, lowest index first
+        for (size_t i = capacity; i-- > 0;) {
+            hot_[i].next = free_head_;
+            free_head_ = static_cast<OrderHandle>(i);
+        }
+    }
+
+    OrderHandle allocate() noexcept {
+        const OrderHandle handle = free_head_;
+        if (handle != NULL_HANDLE) {
+            free_head_ = hot_[handle].next;
+        }
+        return handle;
+    }
+
+    void deallocate(OrderHandle handle) noexcept {
+        hot_[handle].next = free_head_;
+        free_head_ = handle;
+    }
+
+    OrderHot& hot(OrderHandle handle) noexcept { return hot_[handle]; }
+    OrderCold& cold(OrderHandle handle) noexcept { return cold_[handle]; }
+    size_t capacity() const noexcept { return hot_.size(); }
+
+    // Append an order to the back of a level's queue
+    void push_back(CompactLevel& level, uint32_t level_index, OrderHandle handle) noexcept {
+        OrderHot& order = hot_[handle];
+        order.level = level_index;
+        order.next = NULL_HANDLE;
+        order.prev = level.tail;
+        if (level.tail != NULL_HANDLE) {
+            hot_[level.tail].next = handle;
+        } else {
+            level.head = handle;
+        }
+        level.tail = handle;
+        level.total_volume += order.remaining_quantity;
+        ++level.order_count;
+    }
+
+    // Unlink an order from anywhere in its level's queue
+    void unlink(CompactLevel& level, OrderHandle handle) noexcept {
+        OrderHot& order = hot_[handle];
+        if (order.prev != NULL_HANDLE) {
+            hot_[order.prev].next = order.next;
+        } else {
+            level.head = order.next;
+        }
+        if (order.next != NULL_HANDLE) {
+            hot_[order.next].prev = order.prev;
+        } else {
+            level.tail = order.prev;
+        }
+        level.total_volume -= order.remaining_quantity;
+        --level.order_count;
+    }
+
+    // Fill up to `quantity` against the level in FIFO order. Fully filled
+    // orders are unlinked and freed; on_fill(handle, qty) is called for
+    // every fill. Returns the quantity left unfilled.
+    template<typename FillFn>
+    uint32_t match(CompactLevel& level, uint32_t quantity, FillFn&& on_fill) noexcept {
+        OrderHandle handle = level.head;
+        while (handle != NULL_HANDLE && quantity > 0) {
+            OrderHot& passive = hot_[handle];
+            const OrderHandle next = passive.next;
+            if (next != NULL_HANDLE) {
+                __builtin_prefetch(&hot_[next], 1, 3);
+            }
+
+            const uint32_t fill = passive.remaining_quantity < quantity
+                ? passive.remaining_quantity : quantity;
+            on_fill(handle, fill);
+            passive.remaining_quantity -= fill;
+            level.total_volume -= fill;
+            quantity -= fill;
+
+            if (passive.remaining_quantity == 0) {
+                level.head = next;
+                if (next != NULL_HANDLE) {
+                    hot_[next].prev = NULL_HANDLE;
+                } else {
+                    level.tail = NULL_HANDLE;
+                }
+                --level.order_count;
+                deallocate(handle);
+            }
+            handle = next;
+        }
+        return quantity;
+    }
+
+private:
+    std::vector<OrderHot> hot_;
+    std::vector<OrderCold> cold_;
+    OrderHandle free_head_;
+};
+
+} // namespace lob
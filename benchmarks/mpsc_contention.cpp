@@ -0,0 +1,124 @@
+#include "mpsc_queue.hpp"
+#include "matching_engine.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+using namespace lob;
+
+// N gateway threads push EngineCommands into one MPSC ring; one consumer
+// thread drains it, either popping only (queue cost) or applying each
+// command to a MatchingEngine (end-to-end ingress).
+
+using IngressRing = MPSCQueue<EngineCommand, 65536>;
+
+struct ContentionResult {
+    double mops;              // Commands through the ring per microsecond
+    double push_ns;           // Mean producer time per successful push
+    uint64_t full_retries;    // Pushes that found the ring full
+};
+
+ContentionResult run_contention(size_t num_producers, size_t per_producer,
+                                bool apply_to_engine) {
+    auto ring = std::make_unique<IngressRing>();
+    std::unique_ptr<MatchingEngine> engine;
+    if (apply_to_engine) {
+        EngineConfig config;
+        config.order_pool_size = 1 << 20;
+        engine = std::make_unique<MatchingEngine>(config);
+    }
+    
+    const unsigned cores = std::thread::hardware_concurrency();
+    std::atomic<bool> go{false};
+    std::atomic<uint64_t> push_ns_total{0};
+    std::atomic<uint64_t> retries_total{0};
+    
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p] {
+            if (cores > 1) set_cpu_affinity(static_cast<int>(1 + p % (cores - 1)));
+            while (!go.load(std::memory_order_acquire)) {}
+            
+            // Each gateway works its own symbols; adds followed by deletes
+            EngineCommand command{};
+            command.stock_locate = static_cast<uint16_t>(p);
+            command.order_type = OrderType::LIMIT;
+            command.quantity = 100;
+            uint64_t retries = 0;
+            
+            uint64_t start = get_timestamp_ns();
+            for (size_t i = 0; i < per_producer; ++i) {
+                const uint64_t ref = (static_cast<uint64_t>(p) << 40) | (i >> 1);
+                command.order_id = ref + 1;
+                command.timestamp = i;
+                if (i & 1) {
+                    command.type = CommandType::CANCEL;
+                } else {
+                    command.type = CommandType::ADD;
+                    command.side = ((i >> 1) & 1) ? Side::BUY : Side::SELL;
+                    command.price = (command.side == Side::BUY) ? 999900 : 1000100;
+                }
+                while (!ring->push(command)) {
+                    ++retries;
+                    __builtin_ia32_pause();
+                }
+            }
+            push_ns_total += get_timestamp_ns() - start;
+            retries_total += retries;
+        });
+    }
+    
+    const size_t total = num_producers * per_producer;
+    uint64_t start = get_timestamp_ns();
+    go.store(true, std::memory_order_release);
+    
+    size_t consumed = 0;
+    EngineCommand command;
+    while (consumed < total) {
+        if (engine) {
+            consumed += engine->poll_commands(*ring);
+        } else if (ring->pop(command)) {
+            ++consumed;
+        }
+    }
+    uint64_t elapsed = get_timestamp_ns() - start;
+    
+    for (auto& t : producers) t.join();
+    
+    return ContentionResult{
+        total * 1e3 / elapsed,
+        static_cast<double>(push_ns_total.load()) / total,
+        retries_total.load()
+    };
+}
+
+int main(int argc, char** argv) {
+    const size_t per_producer = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    
+    set_cpu_affinity(0);  // Consumer / matching thread
+    
+    std::cout << "MPSC Ingress Contention Benchmark (" << per_producer
+              << " commands per producer)" << std::endl;
+    std::cout << std::setw(10) << "Producers"
+              << std::setw(14) << "Pop M/s"
+              << std::setw(14) << "Push ns"
+              << std::setw(14) << "Full spins"
+              << std::setw(14) << "Apply M/s" << std::endl;
+    
+    for (size_t producers : {1, 2, 4, 8, 16}) {
+        ContentionResult pop_only = run_contention(producers, per_producer, false);
+        ContentionResult applied = run_contention(producers, per_producer, true);
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(10) << producers
+                  << std::setw(14) << pop_only.mops
+                  << std::setw(14) << pop_only.push_ns
+                  << std::setw(14) << pop_only.full_retries
+                  << std::setw(14) << applied.mops << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "order_book.hpp"
+#include "order_pool.hpp"
+#include "compact_order.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+using namespace lob;
+
+// Sweeps a single price level of the given depth with one aggressive order,
+// comparing the pointer-linked Order layout against the compact hot/cold
+// layout. Queue order is shuffled relative to memory order, as it is in a
+// book that has been recycling orders for a while.
+
+struct DepthResult {
+    size_t depth;
+    double pointer_ns_per_fill;
+    double compact_ns_per_fill;
+};
+
+uint64_t sweep_pointer_level(PriceLevel& level, uint32_t quantity) {
+    uint64_t filled = 0;
+    Order* passive = level.head_order;
+    while (passive && quantity > 0) {
+        uint32_t match_qty = std::min(quantity, passive->remaining_quantity);
+        passive->remaining_quantity -= match_qty;
+        level.total_volume -= match_qty;
+        quantity -= match_qty;
+        filled += match_qty;
+
+        Order* next_passive = passive->next;
+        if (passive->remaining_quantity == 0) {
+            level.remove_order(passive);
+        }
+        passive = next_passive;
+    }
+    return filled;
+}
+
+DepthResult run_depth(size_t depth, size_t rounds, std::mt19937& rng) {
+    DepthResult result{depth, 0.0, 0.0};
+    constexpr uint32_t price = 1000000;
+    constexpr uint32_t order_qty = 100;
+    const uint32_t sweep_qty = static_cast<uint32_t>(depth * order_qty);
+
+    std::vector<size_t> queue_order(depth);
+    for (size_t i = 0; i < depth; ++i) queue_order[i] = i;
+
+    // Pointer layout
+    {
+        OrderPool pool(depth);
+        std::vector<Order*> orders(depth);
+        for (size_t i = 0; i < depth; ++i) orders[i] = pool.allocate();
+
+        uint64_t total_ns = 0;
+        for (size_t round = 0; round < rounds; ++round) {
+            std::shuffle(queue_order.begin(), queue_order.end(), rng);
+            PriceLevel level(price);
+            for (size_t i : queue_order) {
+                *orders[i] = Order(i, 0, price, order_qty, Side::SELL, OrderType::LIMIT);
+                level.add_order(orders[i]);
+            }
+
+            uint64_t start = get_timestamp_ns();
+            uint64_t filled = sweep_pointer_level(level, sweep_qty);
+            total_ns += get_timestamp_ns() - start;
+
+            if (filled != sweep_qty) std::cerr << "pointer sweep short" << std::endl;
+        }
+        result.pointer_ns_per_fill = static_cast<double>(total_ns) / (rounds * depth);
+    }
+
+    // Compact layout
+    {
+        CompactOrderStore store(depth);
+        std::vector<OrderHandle> handles(depth);
+
+        uint64_t total_ns = 0;
+        for (size_t round = 0; round < rounds; ++round) {
+            std::shuffle(queue_order.begin(), queue_order.end(), rng);
+            for (size_t i = 0; i < depth; ++i) handles[i] = store.allocate();
+
+            CompactLevel level;
+            level.price = price;
+            for (size_t i : queue_order) {
+                store.hot(handles[i]).remaining_quantity = order_qty;
+                store.cold(handles[i]) = OrderCold{i, 0, price, order_qty, Side::SELL, OrderType::LIMIT};
+                store.push_back(level, 0, handles[i]);
+            }
+
+            uint64_t filled = 0;
+            uint64_t start = get_timestamp_ns();
+            store.match(level, sweep_qty, [&filled](OrderHandle, uint32_t qty) { filled += qty; });
+            total_ns += get_timestamp_ns() - start;
+
+            if (filled != sweep_qty) std::cerr << "compact sweep short" << std::endl;
+        }
+        result.compact_ns_per_fill = static_cast<double>(total_ns) / (rounds * depth);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t max_depth = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+
+    std::cout << "Queue Depth Benchmark (pointer vs compact order layout)" << std::endl;
+    std::cout << "=======================================================" << std::endl;
+    std::cout << "sizeof(Order) = " << sizeof(Order)
+              << ", sizeof(OrderHot) = " << sizeof(OrderHot) << "\n" << std::endl;
+
+    std::cout << std::setw(10) << "Depth"
+              << std::setw(16) << "Pointer ns/fill"
+              << std::setw(16) << "Compact ns/fill"
+              << std::setw(10) << "Speedup" << std::endl;
+
+    std::mt19937 rng(2024);
+    for (size_t depth = 16; depth <= max_depth; depth *= 8) {
+        size_t rounds = std::max<size_t>(1, (1 << 22) / depth);
+        DepthResult r = run_depth(depth, rounds, rng);
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(10) << r.depth
+                  << std::setw(16) << r.pointer_ns_per_fill
+                  << std::setw(16) << r.compact_ns_per_fill
+                  << std::setw(9) << (r.pointer_ns_per_fill / r.compact_ns_per_fill) << "x"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -1,10 +1,15 @@
 #include "matching_engine.hpp"
 #include "feed_handler.hpp"
+#include "partitioned_replay.hpp"
 #include "utils.hpp"
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <thread>
+#include <memory>
 
 using namespace lob;
 
@@ -17,34 +22,164 @@ struct BenchmarkResults {
     std::vector<uint64_t> order_latencies;
 };
 
-BenchmarkResults run_itch_benchmark(const std::string& filename, int cpu_core) {
+struct BenchmarkOptions {
+    int cpu_core = 0;
+    PriceIndexType price_index = PriceIndexType::TREE;
+    OrderDirectoryType order_directory = OrderDirectoryType::HASH;
+    bool compare_directories = false;
+    ReplayMode replay_mode = ReplayMode::MMAP;
+    bool compare_replay = false;
+    bool compare_pipeline = false;
+    bool mirror = true;   // Exchange data: apply events, never match
+};
+
+BenchmarkResults run_itch_benchmark(const std::string& filename,
+                                    const BenchmarkOptions& options) {
     BenchmarkResults results{};
     
     EngineConfig config;
     config.order_pool_size = 10000000;
-    config.cpu_affinity = cpu_core;
+    config.cpu_affinity = options.cpu_core;
     config.enable_logging = false;
+    config.book_config.price_index = options.price_index;
+    config.order_directory = options.order_directory;
+    config.mirror_mode = options.mirror;
     
-    MatchingEngine engine(config);
-    engine.start();
+    auto engine = std::make_unique<MatchingEngine>(config);
+    engine->start();
     
-    FeedHandler feed_handler(engine);
+    FeedHandler feed_handler(*engine);
+    if (std::thread::hardware_concurrency() > 1) {
+        // Decoder on the neighbouring core
+        feed_handler.set_decoder_cpu(options.cpu_core + 1);
+    }
     
     uint64_t start_time = get_timestamp_ns();
     
-    feed_handler.replay_itch_file(filename);
+    feed_handler.replay_itch_file(filename, options.replay_mode);
     
     uint64_t end_time = get_timestamp_ns();
     
     results.total_messages = feed_handler.get_messages_processed();
-    results.total_orders = engine.get_total_orders();
-    results.total_matches = engine.get_total_matches();
+    results.total_orders = engine->get_total_orders();
+    results.total_matches = engine->get_total_matches();
     results.elapsed_ns = end_time - start_time;
     results.messages_per_sec = (results.total_messages * 1e9) / results.elapsed_ns;
     
     return results;
 }
 
+// Order-id table workload shaped like an ITCH day: sequential reference
+// numbers, a bounded live set and ~95% of adds eventually cancelled
+template<typename AddFn, typename CancelFn, typename FindFn>
+uint64_t run_order_map_workload(size_t num_ops, AddFn add, CancelFn cancel, FindFn find,
+                                uint64_t& checksum) {
+    constexpr size_t live_target = 200000;
+    std::vector<uint64_t> live;
+    live.reserve(live_target + 1);
+    std::mt19937_64 rng(12345);
+    Order dummy;
+    uint64_t next_ref = 1;
+    checksum = 0;
+    
+    uint64_t start = get_timestamp_ns();
+    for (size_t i = 0; i < num_ops; ++i) {
+        const uint64_t r = rng();
+        if (live.size() < live_target || (r & 31) == 0) {
+            add(next_ref, &dummy);
+            live.push_back(next_ref++);
+        } else {
+            const size_t pick = (r >> 8) % live.size();
+            if ((r & 31) == 1) {
+                checksum += find(live[pick]);
+            } else {
+                cancel(live[pick]);
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+    uint64_t elapsed = get_timestamp_ns() - start;
+    
+    asm volatile("" :: "r"(checksum));  // Keep lookups observable
+    return elapsed;
+}
+
+void run_order_map_benchmark(size_t num_ops) {
+    std::unordered_map<uint64_t, Order*> std_map;
+    uint64_t std_hits = 0;
+    uint64_t std_ns = run_order_map_workload(num_ops,
+        [&](uint64_t id, Order* order) { std_map[id] = order; },
+        [&](uint64_t id) { std_map.erase(id); },
+        [&](uint64_t id) { return std_map.count(id); }, std_hits);
+    
+    FlatHashMap<Order*> flat_map(262144);
+    uint64_t flat_hits = 0;
+    uint64_t flat_ns = run_order_map_workload(num_ops,
+        [&](uint64_t id, Order* order) { flat_map.insert(id, order); },
+        [&](uint64_t id) { flat_map.erase(id); },
+        [&](uint64_t id) { return flat_map.find(id) ? 1 : 0; }, flat_hits);
+    
+    std::cout << "\n=== Order Map Benchmark (" << num_ops << " ops) ===" << std::endl;
+    std::cout << "std::unordered_map: " << (static_cast<double>(std_ns) / num_ops)
+              << " ns/op" << std::endl;
+    std::cout << "FlatHashMap:        " << (static_cast<double>(flat_ns) / num_ops)
+              << " ns/op" << std::endl;
+    std::cout << "Speedup: " << (static_cast<double>(std_ns) / flat_ns) << "x" << std::endl;
+    std::cout << "Lookup hits:        " << std_hits << " / " << flat_hits << std::endl;
+    std::cout << "====================================\n" << std::endl;
+}
+
+// Replay split by stock_locate: routed, then from a freshly built index
+void run_partitioned_benchmark(const std::string& filename, size_t num_partitions,
+                               const std::string& index_path) {
+    PartitionedReplayConfig config;
+    config.num_partitions = num_partitions;
+    const unsigned cores = std::thread::hardware_concurrency();
+    for (size_t i = 0; i < num_partitions; ++i) {
+        config.partition_cores.push_back(cores > 1 ? static_cast<int>(i % cores) : -1);
+    }
+    config.engine_config.order_pool_size = 10000000 / num_partitions + 1000000;
+    config.engine_config.enable_logging = false;
+    config.engine_config.mirror_mode = true;
+    config.engine_config.execution_backpressure = BackpressurePolicy::DROP;
+    
+    auto report = [](const char* label, const ReplayStats& stats) {
+        std::cout << label << (stats.messages * 1e3 / stats.elapsed_ns)
+                  << " million msg/sec (" << format_duration(stats.elapsed_ns) << ")" << std::endl;
+    };
+    
+    std::cout << "\n=== Partitioned Replay (" << num_partitions << " partitions) ===" << std::endl;
+    ReplayStats routed;
+    {
+        PartitionedReplay replay(config);
+        if (!replay.replay(filename)) return;
+        routed = replay.get_stats();
+        for (size_t i = 0; i < num_partitions; ++i) {
+            const ReplayStats& stats = replay.get_partition_stats(i);
+            std::cout << "Partition " << i << ": " << stats.messages << " messages, "
+                      << stats.resting_orders << " resting, "
+                      << format_duration(stats.elapsed_ns) << std::endl;
+        }
+    }
+    std::cout << "Total Messages: " << routed.messages << std::endl;
+    std::cout << "Total Orders: " << routed.total_orders << std::endl;
+    std::cout << "Resting Orders: " << routed.resting_orders << std::endl;
+    std::cout << "Hidden Trades: " << routed.trades.trades << std::endl;
+    report("Routed:  ", routed);
+    
+    if (!index_path.empty()) {
+        const uint64_t start = get_timestamp_ns();
+        if (!PartitionedReplay::build_index(filename, num_partitions, index_path)) return;
+        std::cout << "Index built in " << format_duration(get_timestamp_ns() - start) << std::endl;
+        
+        PartitionedReplay replay(config);
+        replay.replay(filename, index_path);
+        report("Indexed: ", replay.get_stats());
+    }
+    std::cout << "====================================\n" << std::endl;
+}
+
 void print_results(const BenchmarkResults& results) {
     std::cout << "\n=== ITCH Replay Benchmark Results ===" << std::endl;
     std::cout << "Total Messages: " << results.total_messages << std::endl;
@@ -72,20 +207,113 @@ void print_results(const BenchmarkResults& results) {
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <itch_file> [cpu_core]" << std::endl;
+        std::cerr << "Usage: " << argv[0]
+                  << " <itch_file> [cpu_core] [tree|ladder] [hash|direct|compare]"
+                  << " [stream|mmap|pipelined|compare-io|compare-pipeline] [mirror|match]" << std::endl;
+        std::cerr << "       " << argv[0] << " --order-map [num_ops]" << std::endl;
+        std::cerr << "       " << argv[0]
+                  << " --partitioned <itch_file> [num_partitions] [index_file]" << std::endl;
         return 1;
     }
     
+    if (std::string(argv[1]) == "--order-map") {
+        size_t num_ops = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 50000000;
+        run_order_map_benchmark(num_ops);
+        return 0;
+    }
+    
+    if (std::string(argv[1]) == "--partitioned") {
+        if (argc < 3) return 1;
+        size_t num_partitions = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 4;
+        run_partitioned_benchmark(argv[2], num_partitions ? num_partitions : 1,
+                                  (argc > 4) ? argv[4] : "");
+        return 0;
+    }
+    
     std::string filename = argv[1];
-    int cpu_core = (argc > 2) ? std::atoi(argv[2]) : 0;
+    BenchmarkOptions options;
+    options.cpu_core = (argc > 2) ? std::atoi(argv[2]) : 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "ladder") options.price_index = PriceIndexType::LADDER;
+        else if (arg == "tree") options.price_index = PriceIndexType::TREE;
+        else if (arg == "direct") options.order_directory = OrderDirectoryType::DIRECT;
+        else if (arg == "hash") options.order_directory = OrderDirectoryType::HASH;
+        else if (arg == "compare") options.compare_directories = true;
+        else if (arg == "stream") options.replay_mode = ReplayMode::STREAM;
+        else if (arg == "mmap") options.replay_mode = ReplayMode::MMAP;
+        else if (arg == "pipelined") options.replay_mode = ReplayMode::PIPELINED;
+        else if (arg == "compare-io") options.compare_replay = true;
+        else if (arg == "compare-pipeline") options.compare_pipeline = true;
+        else if (arg == "mirror") options.mirror = true;
+        else if (arg == "match") options.mirror = false;
+    }
     
     std::cout << "ITCH Market Data Replay Benchmark" << std::endl;
     std::cout << "==================================" << std::endl;
     std::cout << "File: " << filename << std::endl;
-    std::cout << "CPU Core: " << cpu_core << std::endl;
+    std::cout << "CPU Core: " << options.cpu_core << std::endl;
+    std::cout << "Price Index: "
+              << (options.price_index == PriceIndexType::LADDER ? "ladder" : "tree") << std::endl;
+    std::cout << "Book Mode: " << (options.mirror ? "mirror" : "match") << std::endl;
     std::cout << "\n";
     
-    BenchmarkResults results = run_itch_benchmark(filename, cpu_core);
+    if (options.compare_replay) {
+        // Stream first, so both runs see the file in the page cache
+        options.replay_mode = ReplayMode::STREAM;
+        BenchmarkResults stream_results = run_itch_benchmark(filename, options);
+        options.replay_mode = ReplayMode::MMAP;
+        BenchmarkResults mmap_results = run_itch_benchmark(filename, options);
+        
+        std::cout << "\n=== Replay I/O Comparison ===" << std::endl;
+        std::cout << "ifstream: " << (stream_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(stream_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "mmap:     " << (mmap_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(mmap_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "Speedup: " << (mmap_results.messages_per_sec / stream_results.messages_per_sec)
+                  << "x" << std::endl;
+        std::cout << "=============================\n" << std::endl;
+        return 0;
+    }
+    
+    if (options.compare_pipeline) {
+        options.replay_mode = ReplayMode::MMAP;
+        BenchmarkResults single_results = run_itch_benchmark(filename, options);
+        options.replay_mode = ReplayMode::PIPELINED;
+        BenchmarkResults pipelined_results = run_itch_benchmark(filename, options);
+        
+        std::cout << "\n=== Decode/Apply Pipeline Comparison ===" << std::endl;
+        std::cout << "One thread: " << (single_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(single_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "Pipelined:  " << (pipelined_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(pipelined_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "Speedup: " << (pipelined_results.messages_per_sec / single_results.messages_per_sec)
+                  << "x" << std::endl;
+        std::cout << "========================================\n" << std::endl;
+        return 0;
+    }
+    
+    if (options.compare_directories) {
+        options.order_directory = OrderDirectoryType::HASH;
+        BenchmarkResults hash_results = run_itch_benchmark(filename, options);
+        options.order_directory = OrderDirectoryType::DIRECT;
+        BenchmarkResults direct_results = run_itch_benchmark(filename, options);
+        
+        std::cout << "\n=== Order Directory Comparison ===" << std::endl;
+        std::cout << "Hash table:   " << (hash_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(hash_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "Direct index: " << (direct_results.messages_per_sec / 1e6)
+                  << " million msg/sec (" << format_duration(direct_results.elapsed_ns) << ")" << std::endl;
+        std::cout << "Speedup: " << (direct_results.messages_per_sec / hash_results.messages_per_sec)
+                  << "x" << std::endl;
+        std::cout << "==================================\n" << std::endl;
+        return 0;
+    }
+    
+    std::cout << "Order Directory: "
+              << (options.order_directory == OrderDirectoryType::DIRECT ? "direct" : "hash") << std::endl;
+    
+    BenchmarkResults results = run_itch_benchmark(filename, options);
     print_results(results);
     
     // Performance validation
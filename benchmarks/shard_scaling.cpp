@@ -0,0 +1,130 @@
+#include "sharded_engine.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <memory>
+
+using namespace lob;
+
+// Multi-symbol command stream shaped like an ITCH day: adds around each
+// symbol's mid, with most orders later cancelled and some executed
+std::vector<EngineCommand> make_commands(size_t num_commands, uint16_t num_symbols) {
+    std::vector<EngineCommand> commands;
+    commands.reserve(num_commands);
+    std::vector<std::vector<uint64_t>> live(num_symbols);
+    std::mt19937_64 rng(7);
+    uint64_t next_ref = 1;
+    
+    for (size_t i = 0; i < num_commands; ++i) {
+        const uint64_t r = rng();
+        const uint16_t locate = static_cast<uint16_t>(r % num_symbols);
+        std::vector<uint64_t>& orders = live[locate];
+        
+        EngineCommand command{};
+        command.stock_locate = locate;
+        command.timestamp = i;
+        
+        if (orders.size() < 64 || ((r >> 16) & 3) == 0) {
+            command.type = CommandType::ADD;
+            command.order_id = next_ref++;
+            command.side = ((r >> 20) & 1) ? Side::BUY : Side::SELL;
+            command.order_type = OrderType::LIMIT;
+            const uint32_t offset = static_cast<uint32_t>((r >> 24) % 20) * 100;
+            command.price = (command.side == Side::BUY) ? 1000000 - 100 - offset
+                                                        : 1000000 + offset;
+            command.quantity = 100;
+            orders.push_back(command.order_id);
+        } else {
+            const size_t pick = (r >> 24) % orders.size();
+            command.order_id = orders[pick];
+            command.quantity = 100;
+            command.type = (((r >> 40) & 7) == 0) ? CommandType::EXECUTE : CommandType::CANCEL;
+            orders[pick] = orders.back();
+            orders.pop_back();
+        }
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+// One engine on this thread: command-at-a-time apply() vs submit_batch()
+double run_single(const std::vector<EngineCommand>& commands, bool batched) {
+    EngineConfig config;
+    config.order_pool_size = 1 << 20;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    ExecutionReport report;
+    
+    constexpr size_t packet = 64;
+    uint64_t start = get_timestamp_ns();
+    for (size_t i = 0; i < commands.size(); i += packet) {
+        const size_t count = std::min(packet, commands.size() - i);
+        if (batched) {
+            engine->submit_batch(&commands[i], count);
+        } else {
+            for (size_t j = 0; j < count; ++j) engine->apply(commands[i + j]);
+        }
+        while (engine->get_execution_queue().pop(report)) {}
+    }
+    uint64_t elapsed = get_timestamp_ns() - start;
+    
+    return commands.size() * 1e3 / elapsed;
+}
+
+double run_sharded(const std::vector<EngineCommand>& commands, size_t num_shards) {
+    ShardedEngineConfig config;
+    config.num_shards = num_shards;
+    config.engine_config.order_pool_size = 1 << 20;
+    const unsigned cores = std::thread::hardware_concurrency();
+    for (size_t i = 0; i < num_shards; ++i) {
+        config.shard_cores.push_back(cores > 1 ? static_cast<int>(1 + i % (cores - 1)) : -1);
+    }
+    
+    ShardedEngine engine(config);
+    
+    uint64_t start = get_timestamp_ns();
+    for (size_t i = 0; i < commands.size(); ++i) {
+        engine.submit(commands[i]);
+        if ((i & 1023) == 0) engine.poll_executions([](const ExecutionReport&) {});
+    }
+    engine.drain();
+    uint64_t elapsed = get_timestamp_ns() - start;
+    
+    return commands.size() * 1e3 / elapsed;  // Million commands per second
+}
+
+int main(int argc, char** argv) {
+    const size_t max_shards = (argc > 1) ? std::strtoull(argv[1], nullptr, 10)
+        : std::max(1u, std::thread::hardware_concurrency() - 1);
+    const size_t num_commands = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+    const uint16_t num_symbols = 1024;
+    
+    set_cpu_affinity(0);  // Router
+    std::vector<EngineCommand> commands = make_commands(num_commands, num_symbols);
+    
+    const double single = run_single(commands, false);
+    const double batched = run_single(commands, true);
+    std::cout << std::fixed << std::setprecision(2)
+              << "Single engine, apply():        " << single << " M cmd/s\n"
+              << "Single engine, submit_batch(): " << batched << " M cmd/s ("
+              << (batched / single) << "x)\n" << std::endl;
+    
+    std::cout << "Shard Scaling Benchmark (" << num_commands << " commands, "
+              << num_symbols << " symbols)" << std::endl;
+    std::cout << std::setw(8) << "Shards" << std::setw(14) << "M cmd/s"
+              << std::setw(10) << "Speedup" << std::endl;
+    
+    double baseline = 0;
+    for (size_t shards = 1; shards <= max_shards; shards *= 2) {
+        double rate = run_sharded(commands, shards);
+        if (shards == 1) baseline = rate;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << shards << std::setw(14) << rate
+                  << std::setw(9) << (rate / baseline) << "x" << std::endl;
+    }
+    
+    return 0;
+}
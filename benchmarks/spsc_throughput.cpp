@@ -0,0 +1,178 @@
+#include "spsc_queue.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <array>
+#include <algorithm>
+
+using namespace lob;
+
+// One producer core streams ExecutionReports to one consumer core through
+// a 65536-slot ring. Compares the previous SPSCQueue (shared indices read
+// on every call, one slot kept empty) against the current one driven by
+// push/pop, push_n/pop_n and reserve/commit + front/pop.
+
+// The SPSCQueue this tree had before cached indices, kept as a baseline
+template<typename T, size_t Capacity>
+class alignas(CACHE_LINE_SIZE) BaselineSPSC {
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_;
+
+public:
+    bool push(const T& item) noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next_head = (head + 1) & (Capacity - 1);
+        if (next_head == tail_.load(std::memory_order_acquire)) return false;
+        buffer_[head] = item;
+        head_.store(next_head, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) noexcept {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        item = buffer_[tail];
+        tail_.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+};
+
+constexpr size_t RING_SIZE = 65536;
+constexpr size_t BATCH = 32;
+
+enum class Mode { BASELINE, SINGLE, BULK, IN_PLACE };
+
+const char* mode_name(Mode mode) {
+    switch (mode) {
+        case Mode::BASELINE: return "baseline push/pop";
+        case Mode::SINGLE:   return "push/pop";
+        case Mode::BULK:     return "push_n/pop_n (32)";
+        case Mode::IN_PLACE: return "reserve/commit";
+    }
+    return "";
+}
+
+template<Mode mode, typename Ring>
+void produce(Ring& ring, size_t count) {
+    ExecutionReport batch[BATCH];
+    size_t sent = 0;
+    while (sent < count) {
+        if constexpr (mode == Mode::BULK) {
+            const size_t n = std::min(BATCH, count - sent);
+            for (size_t i = 0; i < n; ++i) batch[i].order_id = sent + i;
+            size_t done = 0;
+            while (done < n) {
+                const size_t pushed = ring.push_n(batch + done, n - done);
+                if (!pushed) __builtin_ia32_pause();
+                done += pushed;
+            }
+            sent += n;
+        } else if constexpr (mode == Mode::IN_PLACE) {
+            ExecutionReport* slot;
+            while (!(slot = ring.reserve())) __builtin_ia32_pause();
+            slot->order_id = sent++;
+            ring.commit();
+        } else {
+            ExecutionReport report;
+            report.order_id = sent;
+            while (!ring.push(report)) __builtin_ia32_pause();
+            ++sent;
+        }
+    }
+}
+
+// The checksum keeps the consumer's reads live and checks nothing was lost
+template<Mode mode, typename Ring>
+uint64_t consume(Ring& ring, size_t count) {
+    ExecutionReport batch[BATCH];
+    uint64_t checksum = 0;
+    size_t received = 0;
+    while (received < count) {
+        if constexpr (mode == Mode::BULK) {
+            const size_t n = ring.pop_n(batch, BATCH);
+            for (size_t i = 0; i < n; ++i) checksum += batch[i].order_id;
+            received += n;
+        } else if constexpr (mode == Mode::IN_PLACE) {
+            if (const ExecutionReport* report = ring.front()) {
+                checksum += report->order_id;
+                ring.pop();
+                ++received;
+            }
+        } else {
+            ExecutionReport report;
+            if (ring.pop(report)) {
+                checksum += report.order_id;
+                ++received;
+            }
+        }
+    }
+    return checksum;
+}
+
+template<Mode mode, typename Ring>
+double run_once(Ring& ring, size_t count, int producer_core, int consumer_core) {
+    std::atomic<bool> go{false};
+    std::thread producer([&] {
+        if (producer_core >= 0) set_cpu_affinity(producer_core);
+        while (!go.load(std::memory_order_acquire)) {}
+        produce<mode>(ring, count);
+    });
+
+    if (consumer_core >= 0) set_cpu_affinity(consumer_core);
+    uint64_t start = get_timestamp_ns();
+    go.store(true, std::memory_order_release);
+    const uint64_t checksum = consume<mode>(ring, count);
+    uint64_t elapsed = get_timestamp_ns() - start;
+    producer.join();
+
+    if (checksum != static_cast<uint64_t>(count) * (count - 1) / 2) {
+        std::cerr << "Checksum mismatch in " << mode_name(mode) << std::endl;
+    }
+    return count * 1e3 / elapsed;  // Million reports per second
+}
+
+template<Mode mode, typename Ring>
+double run(Ring& ring, size_t count, int producer_core, int consumer_core, size_t runs) {
+    double best = 0;
+    for (size_t r = 0; r < runs; ++r) {
+        best = std::max(best, run_once<mode>(ring, count, producer_core, consumer_core));
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    const size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+    const size_t runs = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    const unsigned cores = std::thread::hardware_concurrency();
+    const int producer_core = (cores > 1) ? 1 : -1;
+    const int consumer_core = 0;
+
+    std::cout << "SPSC Cross-Core Throughput (" << count << " x " << sizeof(ExecutionReport)
+              << "-byte reports, ring " << RING_SIZE << ", best of " << runs << ")" << std::endl;
+    if (cores < 2) {
+        std::cout << "Only one core available - producer and consumer share it" << std::endl;
+    }
+
+    auto baseline = std::make_unique<BaselineSPSC<ExecutionReport, RING_SIZE>>();
+    SPSCQueue<ExecutionReport> ring(RING_SIZE);
+
+    const double results[] = {
+        run<Mode::BASELINE>(*baseline, count, producer_core, consumer_core, runs),
+        run<Mode::SINGLE>(ring, count, producer_core, consumer_core, runs),
+        run<Mode::BULK>(ring, count, producer_core, consumer_core, runs),
+        run<Mode::IN_PLACE>(ring, count, producer_core, consumer_core, runs),
+    };
+    const Mode modes[] = {Mode::BASELINE, Mode::SINGLE, Mode::BULK, Mode::IN_PLACE};
+    for (size_t i = 0; i < 4; ++i) {
+        std::cout << std::left << std::setw(22) << mode_name(modes[i]) << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(10) << results[i]
+                  << " M/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "compact_order.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace lob;
+
+// The compact layout is a benchmark prototype, so its test lives here
+// rather than with the library tests
+
+TEST(CompactOrderStoreTest, MatchesInFifoOrderAndRecycles) {
+    CompactOrderStore store(4);
+    CompactLevel level;
+    level.price = 100000;
+    
+    std::vector<OrderHandle> handles;
+    for (uint32_t i = 0; i < 3; ++i) {
+        OrderHandle handle = store.allocate();
+        store.hot(handle).remaining_quantity = 100;
+        store.cold(handle) = OrderCold{i, 0, 100000, 100, Side::SELL, OrderType::LIMIT};
+        store.push_back(level, 0, handle);
+        handles.push_back(handle);
+    }
+    
+    // Cancel from the middle, then sweep
+    store.unlink(level, handles[1]);
+    store.deallocate(handles[1]);
+    EXPECT_EQ(level.total_volume, 200);
+    
+    std::vector<uint64_t> filled_ids;
+    uint32_t left = store.match(level, 150, [&](OrderHandle handle, uint32_t) {
+        filled_ids.push_back(store.cold(handle).order_id);
+    });
+    
+    EXPECT_EQ(left, 0);
+    EXPECT_EQ(filled_ids, (std::vector<uint64_t>{0, 2}));
+    EXPECT_EQ(level.order_count, 1);
+    EXPECT_EQ(level.head, handles[2]);
+    EXPECT_EQ(store.hot(handles[2]).remaining_quantity, 50);
+    
+    // Most recently freed handle is reused first
+    EXPECT_EQ(store.allocate(), handles[0]);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
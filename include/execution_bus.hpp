@@ -0,0 +1,184 @@
+#pragma once
+
+#include "order.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace lob {
+
+// Broadcast ring of ExecutionReports in shared memory, for risk, drop-copy
+// and P&L processes. One writer (normally the engine's execution drain
+// sink) publishes; any number of reader processes map the region
+// read-only and keep their own cursor. The writer never waits for
+// readers - a reader that falls more than a ring behind is overrun, finds
+// out from the slot sequence, and skips to the oldest report still held.
+//
+// Each slot is one cache line: a sequence word and the report fields. The
+// writer makes the sequence odd while it writes (seqlock), so a reader
+// validates its copy of a slot against the writer lapping it.
+namespace detail {
+
+constexpr uint64_t BUS_MAGIC = 0x4C4F42425553ULL;  // "LOBBUS"
+constexpr uint32_t BUS_VERSION = 1;
+
+struct BusHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slot_size;
+    uint64_t capacity;                                    // Slots, power of 2
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;  // Reports published
+};
+
+struct alignas(CACHE_LINE_SIZE) BusSlot {
+    static constexpr size_t REPORT_BYTES = CACHE_LINE_SIZE - sizeof(uint64_t);
+
+    // 2n+1 while report n is written, 2n+2 once it is complete
+    std::atomic<uint64_t> sequence;
+    unsigned char report[REPORT_BYTES];
+};
+
+static_assert(sizeof(BusSlot) == CACHE_LINE_SIZE, "One cache line per report");
+static_assert(offsetof(ExecutionReport, is_full_fill) + sizeof(bool) <= BusSlot::REPORT_BYTES,
+              "ExecutionReport fields must fit in a bus slot");
+
+// A mapped bus region
+struct BusRegion {
+    void* base = nullptr;
+    size_t bytes = 0;
+    int fd = -1;
+    BusHeader* header = nullptr;
+    BusSlot* slots = nullptr;
+    uint64_t mask = 0;
+
+    ~BusRegion();
+};
+
+} // namespace detail
+
+class ExecutionBusWriter {
+public:
+    // A name ("/lob_fills") creates a POSIX shm object that readers open
+    // by name; nullptr creates an anonymous memfd to hand to readers by
+    // fd(). Capacity is rounded up to a power of 2. Returns nullptr on
+    // failure.
+    static std::unique_ptr<ExecutionBusWriter> create(const char* name, size_t capacity);
+    ~ExecutionBusWriter();
+
+    // Disable copy and move
+    ExecutionBusWriter(const ExecutionBusWriter&) = delete;
+    ExecutionBusWriter& operator=(const ExecutionBusWriter&) = delete;
+
+    void publish(const ExecutionReport& report) noexcept {
+        detail::BusSlot& slot = region_.slots[head_ & region_.mask];
+        slot.sequence.store(2 * head_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(slot.report, &report, detail::BusSlot::REPORT_BYTES);
+        slot.sequence.store(2 * head_ + 2, std::memory_order_release);
+        region_.header->head.store(++head_, std::memory_order_release);
+    }
+
+    // Batch form, usable directly as an ExecutionSink
+    void publish(const ExecutionReport* reports, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i) publish(reports[i]);
+    }
+
+    int fd() const noexcept { return region_.fd; }
+    uint64_t published() const noexcept { return head_; }
+    size_t capacity() const noexcept { return region_.mask + 1; }
+
+private:
+    ExecutionBusWriter() = default;
+
+    detail::BusRegion region_;
+    uint64_t head_ = 0;   // Writer's copy of header->head
+    char name_[64] = {};  // shm object to unlink, empty for memfd
+};
+
+enum class BusReadStatus : uint8_t {
+    OK = 0,       // A report was read
+    EMPTY = 1,    // Caught up with the writer
+    OVERRUN = 2   // Lapped; the cursor has skipped to the oldest report held
+};
+
+class ExecutionBusReader {
+public:
+    // Map an existing bus read-only, by shm name or by a memfd passed from
+    // the writer. Reading starts at the next report published, or at the
+    // oldest one still held with from_oldest. Returns nullptr on failure.
+    static std::unique_ptr<ExecutionBusReader> open(const char* name, bool from_oldest = false);
+    static std::unique_ptr<ExecutionBusReader> open(int fd, bool from_oldest = false);
+
+    // Disable copy and move
+    ExecutionBusReader(const ExecutionBusReader&) = delete;
+    ExecutionBusReader& operator=(const ExecutionBusReader&) = delete;
+
+    BusReadStatus read(ExecutionReport& report) noexcept {
+        const detail::BusSlot& slot = region_.slots[cursor_ & region_.mask];
+        const uint64_t expected = 2 * cursor_ + 2;
+
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before < expected) {
+            return BusReadStatus::EMPTY;  // Not written, or still being written
+        }
+        if (before == expected) {
+            std::memcpy(&report, slot.report, detail::BusSlot::REPORT_BYTES);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == expected) {
+                ++cursor_;
+                return BusReadStatus::OK;
+            }
+        }
+        skip_to_oldest();
+        return BusReadStatus::OVERRUN;
+    }
+
+    // Read up to max_reports, passing each to on_report. Overruns are
+    // skipped (and counted in lost()). Returns the number read.
+    template<typename Fn>
+    size_t poll(Fn&& on_report, size_t max_reports = ~size_t{0}) {
+        size_t count = 0;
+        ExecutionReport report;
+        while (count < max_reports) {
+            const BusReadStatus status = read(report);
+            if (status == BusReadStatus::EMPTY) break;
+            if (status == BusReadStatus::OK) {
+                on_report(report);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    uint64_t cursor() const noexcept { return cursor_; }
+    uint64_t lost() const noexcept { return lost_; }
+    uint64_t lag() const noexcept {
+        return region_.header->head.load(std::memory_order_acquire) - cursor_;
+    }
+
+private:
+    ExecutionBusReader() = default;
+    static std::unique_ptr<ExecutionBusReader> attach(int fd, bool from_oldest);
+
+    // The slot for report head is the one the writer may be on now
+    uint64_t oldest_held() const noexcept {
+        const uint64_t head = region_.header->head.load(std::memory_order_acquire);
+        return (head > region_.mask) ? head - region_.mask : 0;
+    }
+
+    void skip_to_oldest() noexcept {
+        const uint64_t oldest = oldest_held();
+        if (oldest > cursor_) {
+            lost_ += oldest - cursor_;
+            cursor_ = oldest;
+        }
+    }
+
+    detail::BusRegion region_;
+    uint64_t cursor_ = 0;
+    uint64_t lost_ = 0;
+};
+
+} // namespace lob
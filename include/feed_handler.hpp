@@ -6,6 +6,7 @@
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <array>
 
 namespace lob {
 
@@ -32,11 +33,25 @@ enum class ITCHMessageType : uint8_t {
     NOII = 'I'
 };
 
+// ITCH Stock Directory message (type 'R'), fields we use
+struct ITCHStockDirectory {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];     // nanoseconds since midnight
+    char stock[8];            // space padded
+    char market_category;
+    char financial_status;
+} __attribute__((packed));
+
+// Every message body below starts with stock_locate, tracking_number and a
+// 6-byte big-endian timestamp (nanoseconds since midnight). Sizes are the
+// ITCH 5.0 message lengths less the type byte.
+
 // ITCH Add Order message (type 'A')
 struct ITCHAddOrder {
     uint16_t stock_locate;
     uint16_t tracking_number;
-    uint64_t timestamp;       // nanoseconds
+    uint8_t timestamp[6];
     uint64_t order_ref_num;
     char buy_sell_indicator;  // 'B' or 'S'
     uint32_t shares;
@@ -44,11 +59,46 @@ struct ITCHAddOrder {
     uint32_t price;           // fixed-point 4 decimal places
 } __attribute__((packed));
 
+// ITCH Add Order with MPID Attribution message (type 'F')
+struct ITCHAddOrderMPID {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t order_ref_num;
+    char buy_sell_indicator;
+    uint32_t shares;
+    char stock[8];
+    uint32_t price;
+    char attribution[4];      // Market participant id
+} __attribute__((packed));
+
+// ITCH Order Executed message (type 'E')
+struct ITCHOrderExecuted {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t order_ref_num;
+    uint32_t executed_shares;
+    uint64_t match_number;
+} __attribute__((packed));
+
+// ITCH Order Executed with Price message (type 'C')
+struct ITCHOrderExecutedWithPrice {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t order_ref_num;
+    uint32_t executed_shares;
+    uint64_t match_number;
+    char printable;           // 'N' prints are not counted in volume
+    uint32_t execution_price;
+} __attribute__((packed));
+
 // ITCH Order Cancel message (type 'X')
 struct ITCHOrderCancel {
     uint16_t stock_locate;
     uint16_t tracking_number;
-    uint64_t timestamp;
+    uint8_t timestamp[6];
     uint64_t order_ref_num;
     uint32_t cancelled_shares;
 } __attribute__((packed));
@@ -57,10 +107,81 @@ struct ITCHOrderCancel {
 struct ITCHOrderDelete {
     uint16_t stock_locate;
     uint16_t tracking_number;
-    uint64_t timestamp;
+    uint8_t timestamp[6];
     uint64_t order_ref_num;
 } __attribute__((packed));
 
+// ITCH Order Replace message (type 'U')
+struct ITCHOrderReplace {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t original_order_ref_num;
+    uint64_t new_order_ref_num;
+    uint32_t shares;
+    uint32_t price;
+} __attribute__((packed));
+
+// ITCH Trade message (type 'P') - execution against a non-displayed order
+struct ITCHTrade {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t order_ref_num;   // Always 0
+    char buy_sell_indicator;
+    uint32_t shares;
+    char stock[8];
+    uint32_t price;
+    uint64_t match_number;
+} __attribute__((packed));
+
+// ITCH Cross Trade message (type 'Q')
+struct ITCHCrossTrade {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t shares;
+    char stock[8];
+    uint32_t cross_price;
+    uint64_t match_number;
+    char cross_type;          // 'O'pening, 'C'losing, 'H'alt/IPO, 'I'ntraday
+} __attribute__((packed));
+
+// ITCH Broken Trade message (type 'B')
+struct ITCHBrokenTrade {
+    uint16_t stock_locate;
+    uint16_t tracking_number;
+    uint8_t timestamp[6];
+    uint64_t match_number;
+} __attribute__((packed));
+
+static_assert(sizeof(ITCHAddOrder) == 35, "ITCH 'A' is 36 bytes");
+static_assert(sizeof(ITCHAddOrderMPID) == 39, "ITCH 'F' is 40 bytes");
+static_assert(sizeof(ITCHOrderExecuted) == 30, "ITCH 'E' is 31 bytes");
+static_assert(sizeof(ITCHOrderExecutedWithPrice) == 35, "ITCH 'C' is 36 bytes");
+static_assert(sizeof(ITCHOrderCancel) == 22, "ITCH 'X' is 23 bytes");
+static_assert(sizeof(ITCHOrderDelete) == 18, "ITCH 'D' is 19 bytes");
+static_assert(sizeof(ITCHOrderReplace) == 34, "ITCH 'U' is 35 bytes");
+static_assert(sizeof(ITCHTrade) == 43, "ITCH 'P' is 44 bytes");
+static_assert(sizeof(ITCHCrossTrade) == 39, "ITCH 'Q' is 40 bytes");
+static_assert(sizeof(ITCHBrokenTrade) == 18, "ITCH 'B' is 19 bytes");
+
+// Prints that leave the displayed book alone (P, Q, B)
+struct TradeStats {
+    uint64_t trades = 0;         // Non-cross trades against hidden orders
+    uint64_t trade_volume = 0;
+    uint64_t cross_trades = 0;
+    uint64_t cross_volume = 0;
+    uint64_t broken_trades = 0;
+};
+
+// How replay_itch_file reads the file
+enum class ReplayMode : uint8_t {
+    STREAM = 0,     // ifstream reads, one buffer per message
+    MMAP = 1,       // Parse in place from a read-only mapping, with read-ahead
+    PIPELINED = 2   // As MMAP, decoded on a second thread; this one only applies
+};
+
 // Feed handler for processing market data
 class FeedHandler {
 public:
@@ -68,7 +189,32 @@ public:
     ~FeedHandler();
     
     // File-based replay
-    void replay_itch_file(const std::string& filename);
+    void replay_itch_file(const std::string& filename, ReplayMode mode = ReplayMode::MMAP);
+    
+    // Process length-prefixed messages (2-byte big-endian length, then the
+    // message) straight from memory. Returns the bytes consumed, which
+    // stops short of a truncated trailing message.
+    size_t replay_itch_buffer(const uint8_t* data, size_t size);
+    
+    // Process the length-prefixed messages at data + offsets[i], in the
+    // order given - one partition of a file split by stock_locate. Stops
+    // at the first offset that does not hold a complete message inside
+    // size bytes; returns the number processed.
+    size_t replay_itch_messages(const uint8_t* data, size_t size,
+                                const uint64_t* offsets, size_t count);
+    
+    // The mmap replay keeps the kernel reading this far ahead of the parser
+    static constexpr size_t READ_AHEAD_BYTES = 64 << 20;
+    static constexpr size_t READ_AHEAD_CHUNK = 4 << 20;
+    
+    // PIPELINED replay: the decoder thread (pinned when decoder_cpu >= 0)
+    // pushes EngineCommands in batches of DECODE_BATCH through a ring of
+    // PIPELINE_RING_SIZE; the replaying thread applies them with
+    // submit_batch.
+    static constexpr size_t DECODE_BATCH = 64;
+    static constexpr size_t PIPELINE_RING_SIZE = 1 << 16;
+    
+    void set_decoder_cpu(int cpu) noexcept { decoder_cpu_ = cpu; }
     
     // Real-time feed (placeholder for multicast/UDP)
     void start_live_feed(const std::string& interface, uint16_t port);
@@ -81,6 +227,8 @@ public:
     
     uint64_t get_messages_per_second() const noexcept;
     
+    const TradeStats& get_trade_stats() const noexcept { return trade_stats_; }
+    
 private:
     MatchingEngine& engine_;
     
@@ -90,17 +238,59 @@ private:
     
     std::thread feed_thread_;
     
-    // Message parsing
+    TradeStats trade_stats_;  // Written by whichever thread decodes
+    int decoder_cpu_ = -1;
+    
+    // Replay paths
+    void replay_stream(std::ifstream& file);
+    void replay_mapped(const uint8_t* data, size_t size, bool pipelined);
+    void report_progress(uint64_t message_count, uint64_t start_time) const;
+    
+    // Parse the complete messages in data, handing each decoded command
+    // to sink. Returns the bytes consumed.
+    template<typename Sink>
+    size_t decode_buffer(const uint8_t* data, size_t size, Sink&& sink);
+    
+    // Message decoding. Every message that changes a book becomes one
+    // EngineCommand. decode_message looks the type up in a 256-entry table
+    // of body length and decoder, so dispatch is one length check and one
+    // indirect call.
+    struct MessageDecoder {
+        size_t length;   // Minimum body size
+        bool (FeedHandler::*decode)(const uint8_t* data, EngineCommand& command);
+    };
+    static const std::array<MessageDecoder, 256> MESSAGE_DECODERS;
+    static std::array<MessageDecoder, 256> make_message_decoders();
+    
+    template<typename Message, bool (FeedHandler::*Decode)(const Message&, EngineCommand&)>
+    bool dispatch(const uint8_t* data, EngineCommand& command) {
+        return (this->*Decode)(*reinterpret_cast<const Message*>(data), command);
+    }
+    bool ignore_message(const uint8_t*, EngineCommand&) { return false; }
+    
+    bool decode_message(uint8_t msg_type, const uint8_t* data, size_t length,
+                        EngineCommand& command) {
+        // Unknown types map to ignore_message; short messages are dropped
+        const MessageDecoder& decoder = MESSAGE_DECODERS[msg_type];
+        return length >= decoder.length && (this->*decoder.decode)(data, command);
+    }
     void process_message(uint8_t msg_type, const uint8_t* data, size_t length);
-    void handle_add_order(const ITCHAddOrder& msg);
-    void handle_order_cancel(const ITCHOrderCancel& msg);
-    void handle_order_delete(const ITCHOrderDelete& msg);
+    
+    bool decode_stock_directory(const ITCHStockDirectory& msg, EngineCommand& command);
+    bool decode_add_order(const ITCHAddOrder& msg, EngineCommand& command);
+    bool decode_order_executed(const ITCHOrderExecuted& msg, EngineCommand& command);
+    bool decode_order_executed_with_price(const ITCHOrderExecutedWithPrice& msg,
+                                          EngineCommand& command);
+    bool decode_order_cancel(const ITCHOrderCancel& msg, EngineCommand& command);
+    bool decode_order_delete(const ITCHOrderDelete& msg, EngineCommand& command);
+    bool decode_order_replace(const ITCHOrderReplace& msg, EngineCommand& command);
+    bool decode_trade(const ITCHTrade& msg, EngineCommand& command);
+    bool decode_cross_trade(const ITCHCrossTrade& msg, EngineCommand& command);
+    bool decode_broken_trade(const ITCHBrokenTrade& msg, EngineCommand& command);
     
     // Helpers
     static uint16_t parse_uint16(const uint8_t* data);
-    static uint32_t parse_uint32(const uint8_t* data);
-    static uint64_t parse_uint64(const uint8_t* data);
-    static std::string parse_stock_symbol(const char* data);
+    static uint64_t parse_timestamp(const uint8_t* data);  // 6-byte field
 };
 
 } // namespace lob
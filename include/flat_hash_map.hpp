@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <vector>
+
+namespace lob {
+
+// Open-addressing hash table keyed by 64-bit ids (order ids, ITCH
+// reference numbers). Linear probing over a flat power-of-two array, with
+// backward-shift deletion so lookups never have to skip tombstones.
+// The all-ones key is reserved as the empty marker.
+template<typename V>
+class FlatHashMap {
+public:
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;
+
+    explicit FlatHashMap(size_t expected = 1024) { rehash(slots_for(expected)); }
+
+    // Disable copy and move
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    V* find(uint64_t key) noexcept {
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            Slot& slot = slots_[i];
+            if (slot.key == key) return &slot.value;
+            if (slot.key == EMPTY_KEY) return nullptr;
+        }
+    }
+
+    const V* find(uint64_t key) const noexcept {
+        return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    // Insert or overwrite
+    void insert(uint64_t key, const V& value) {
+        assert(key != EMPTY_KEY);
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+
+        size_t i = home(key);
+        while (slots_[i].key != EMPTY_KEY) {
+            if (slots_[i].key == key) {
+                slots_[i].value = value;
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+        slots_[i].key = key;
+        slots_[i].value = value;
+        ++size_;
+    }
+
+    bool erase(uint64_t key) noexcept {
+        V unused;
+        return extract(key, unused);
+    }
+
+    // Remove the entry and hand back its value in a single probe sequence
+    bool extract(uint64_t key, V& out) noexcept {
+        size_t i = home(key);
+        while (slots_[i].key != key) {
+            if (slots_[i].key == EMPTY_KEY) return false;
+            i = (i + 1) & mask_;
+        }
+        out = slots_[i].value;
+
+        // Backward-shift: pull later entries of the cluster into the hole
+        // unless they already sit at or after their home slot
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask_; slots_[j].key != EMPTY_KEY; j = (j + 1) & mask_) {
+            const size_t h = home(slots_[j].key);
+            if (((j - h) & mask_) >= ((j - hole) & mask_)) {
+                slots_[hole] = slots_[j];
+                hole = j;
+            }
+        }
+        slots_[hole].key = EMPTY_KEY;
+        --size_;
+        return true;
+    }
+
+    // Pull the home slot of `key` into cache ahead of a find/insert/erase
+    void prefetch(uint64_t key) const noexcept {
+        __builtin_prefetch(&slots_[home(key)], 0, 3);
+    }
+
+    void clear() noexcept {
+        for (Slot& slot : slots_) slot.key = EMPTY_KEY;
+        size_ = 0;
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_t capacity() const noexcept { return slots_.size(); }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const Slot& slot : slots_) {
+            if (slot.key != EMPTY_KEY) fn(slot.key, slot.value);
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        V value{};
+    };
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t shift_ = 0;
+    size_t size_ = 0;
+
+    // Fibonacci hashing spreads sequential ids across the table
+    size_t home(uint64_t key) const noexcept {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    static size_t slots_for(size_t expected) noexcept {
+        size_t slots = 16;
+        while (slots < expected * 2) slots <<= 1;
+        return slots;
+    }
+
+    void rehash(size_t new_slots) {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.assign(new_slots, Slot{});
+        mask_ = new_slots - 1;
+        shift_ = 64 - __builtin_ctzll(new_slots);
+        size_ = 0;
+        for (const Slot& slot : old) {
+            if (slot.key != EMPTY_KEY) insert(slot.key, slot.value);
+        }
+    }
+};
+
+} // namespace lob
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "order_book.hpp"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace lob {
+
+class HugePageArena;
+
+// Chunked PriceLevel allocator with an intrusive LIFO free list threaded
+// through PriceLevel::parent. Chunks are only carved out when the free list
+// and the current chunk are both used up, so an idle symbol costs nothing.
+//
+// Chunks come from a HugePageArena while it has room and from the heap
+// afterwards. One pool can back every book of an engine (or shard); it is
+// not thread-safe.
+class PriceLevelPool {
+public:
+    explicit PriceLevelPool(size_t chunk_levels = 4096, HugePageArena* arena = nullptr);
+    ~PriceLevelPool();
+
+    // Disable copy and move
+    PriceLevelPool(const PriceLevelPool&) = delete;
+    PriceLevelPool& operator=(const PriceLevelPool&) = delete;
+
+    PriceLevel* allocate(uint32_t price) {
+        PriceLevel* level = free_list_;
+        if (level) {
+            free_list_ = level->parent;
+        } else {
+            if (chunk_next_ == chunk_end_) grow();
+            level = chunk_next_++;
+        }
+        ++in_use_;
+        return new (level) PriceLevel(price);
+    }
+
+    void deallocate(PriceLevel* level) noexcept {
+        level->parent = free_list_;
+        free_list_ = level;
+        --in_use_;
+    }
+
+    size_t in_use() const noexcept { return in_use_; }
+    size_t capacity() const noexcept { return chunk_count_ * chunk_levels_; }
+    size_t chunk_count() const noexcept { return chunk_count_; }
+
+private:
+    size_t chunk_levels_;
+    HugePageArena* arena_;
+
+    PriceLevel* free_list_ = nullptr;
+    PriceLevel* chunk_next_ = nullptr;
+    PriceLevel* chunk_end_ = nullptr;
+    size_t chunk_count_ = 0;
+    size_t in_use_ = 0;
+
+    // Heap chunks, freed with the pool (arena chunks belong to the arena)
+    std::vector<PriceLevel*> heap_chunks_;
+
+    void grow();
+};
+
+} // namespace lob
@@ -4,13 +4,43 @@
 #include <unordered_map> // THEN THIS
 
 #include "order_book.hpp"
+#include "order_pool.hpp"
+#include "level_pool.hpp"
+#include "symbol_directory.hpp"
+#include "spsc_queue.hpp"
+#include "mpsc_queue.hpp"
 #include "order.hpp"
 #include <memory>
+#include <vector>
 #include <thread>
 #include <atomic>
+#include <functional>
 
 namespace lob {
 
+// ITCH stock_locate codes are 16-bit
+constexpr size_t MAX_STOCK_LOCATE = 65535;
+
+// What the engine does with a fill when the execution ring is full
+enum class BackpressurePolicy : uint8_t {
+    SPIN = 0,   // Busy-wait for the consumer; needs one running
+    YIELD = 1,  // As SPIN, yielding the core between retries
+    DROP = 2,   // Discard the fill and count it (get_dropped_reports)
+    SPILL = 3   // Park it in an overflow buffer, moved to the ring in order
+};
+
+// How the event loop waits when its ingress ring is empty, from lowest
+// wake-up latency to least CPU burnt between bursts
+enum class IdleStrategy : uint8_t {
+    BUSY_SPIN = 0,  // Re-poll immediately
+    PAUSE = 1,      // One pause instruction per empty poll
+    BACKOFF = 2,    // Pause 1, 2, 4 ... 1024 times, then yield
+    PARK = 3        // Futex sleep until enqueue() or stop(); yields while fills are spilled
+};
+
+// Consumer of drained fills, called with batches in ring order
+using ExecutionSink = std::function<void(const ExecutionReport* reports, size_t count)>;
+
 // Matching engine configuration
 struct EngineConfig {
     size_t num_symbols = 100;
@@ -18,8 +48,65 @@ struct EngineConfig {
     bool enable_logging = false;
     int cpu_affinity = -1; // -1 = no affinity
     int numa_node = -1;    // -1 = no preference
+    BookConfig book_config;  // Default for books created on first order
+    
+    // Engine-wide order id index covering every book. DIRECT indexes ids
+    // into a sliding window, which suits ITCH reference numbers.
+    OrderDirectoryType order_directory = OrderDirectoryType::HASH;
+    size_t direct_window = 1 << 22;  // Ids covered by the DIRECT window
+    
+    // Back the order pool and the shared level pool with one huge-page
+    // arena (bound to numa_node when set). The arena reserves one level
+    // chunk per symbol; the level pool spills to the heap beyond that.
+    bool use_huge_page_arena = true;
+    
+    // Execution ring slots (rounded up to a power of 2), mapped from huge pages
+    size_t execution_queue_size = 65536;
+    
+    // Full execution ring handling. SPILL never blocks or loses a fill;
+    // spilled fills go out on the next push, batch or flush_executions().
+    BackpressurePolicy execution_backpressure = BackpressurePolicy::SPILL;
+    
+    // Run an event loop thread between start() and stop(), pinned to
+    // cpu_affinity, that applies commands posted with enqueue(). Off, the
+    // engine is driven directly on the caller's thread.
+    bool run_event_loop = false;
+    IdleStrategy idle_strategy = IdleStrategy::PAUSE;
+    
+    // Mirror an exchange feed: adds rest as given without the crossing
+    // check, so the only fills are the venue's own executions (ITCH E/C).
+    // A replayed book can be briefly locked or crossed, as on the venue.
+    bool mirror_mode = false;
 };
 
+// Order-entry command, as carried on the shard command rings. Books are
+// addressed by stock_locate; cancel/reduce/execute look the order up by id
+// but still carry its locate, which is what routes them to a shard.
+enum class CommandType : uint8_t {
+    ADD = 0,       // New order
+    CANCEL = 1,    // Remove the order (ITCH D)
+    REDUCE = 2,    // Take quantity off the order (ITCH X)
+    MODIFY = 3,    // Set the order's remaining quantity
+    EXECUTE = 4,   // Execution against the resting order at price (ITCH E/C)
+    REPLACE = 5,   // New reference, price and quantity, same side and book (ITCH U)
+    DIRECTORY = 6  // Register stock_locate's book; order_id holds the SymbolKey (ITCH R)
+};
+
+struct EngineCommand {
+    uint64_t order_id;
+    uint64_t new_order_id;  // REPLACE: reference of the replacing order
+    uint64_t timestamp;
+    uint32_t price;      // EXECUTE: print price, 0 for the resting price
+    uint32_t quantity;   // REDUCE/EXECUTE: shares taken off; MODIFY/REPLACE: new quantity
+    uint16_t stock_locate;
+    CommandType type;
+    Side side;
+    OrderType order_type;
+};
+
+// Event loop ingress, fed by any number of gateway threads
+using IngressQueue = MPSCQueue<EngineCommand, 65536>;
+
 // Main matching engine
 class MatchingEngine {
 public:
@@ -33,46 +120,203 @@ public:
     void cancel_order(const char* symbol, uint64_t order_id);
     void modify_order(const char* symbol, uint64_t order_id, uint32_t new_quantity);
     
+    // Books addressed by SymbolId, resolved once through get_symbol_id()
+    void submit_order(SymbolId symbol, uint64_t order_id, uint64_t timestamp,
+                     uint32_t price, uint32_t quantity, Side side, OrderType type);
+    
+    void cancel_order(SymbolId symbol, uint64_t order_id);
+    void modify_order(SymbolId symbol, uint64_t order_id, uint32_t new_quantity);
+    
+    // Apply one command on the calling thread
+    void apply(const EngineCommand& command);
+    
+    // Apply commands in order, prefetching what the commands a few places
+    // ahead will touch, one pointer hop per stage: the directory slot, then
+    // the book or resting order, then the level slot or the order's level
+    // and neighbours, then the ladder level
+    void submit_batch(const EngineCommand* commands, size_t count);
+    
+    // Pop up to max_commands from an ingress ring (SPSCQueue, or MPSCQueue
+    // when several gateway threads feed this engine) and apply them as one
+    // batch. Returns the number applied.
+    static constexpr size_t POLL_BATCH = 64;
+    
+    template<typename Queue>
+    size_t poll_commands(Queue& queue, size_t max_commands = POLL_BATCH) {
+        EngineCommand batch[POLL_BATCH];
+        if (max_commands > POLL_BATCH) max_commands = POLL_BATCH;
+        
+        const size_t count = queue.pop_n(batch, max_commands);
+        if (count) submit_batch(batch, count);
+        return count;
+    }
+    
+    // By order reference alone (ITCH D/X/E/C), one directory lookup each
+    void delete_order(uint64_t order_id);
+    void reduce_order(uint64_t order_id, uint32_t cancelled_quantity);
+    void execute_order(uint64_t order_id, uint32_t executed_quantity, uint64_t timestamp);
+    void execute_order(uint64_t order_id, uint32_t executed_quantity, uint64_t timestamp,
+                       uint32_t price);
+    
+    // Cancel the order and enter its replacement on the same book and side.
+    // The replacement loses time priority, as on the exchange.
+    void replace_order(uint64_t order_id, uint64_t new_order_id, uint64_t timestamp,
+                       uint32_t price, uint32_t quantity);
+    
+    Order* find_order(uint64_t order_id) noexcept { return order_directory_.find(order_id); }
+    void prefetch_order(uint64_t order_id) const noexcept { order_directory_.prefetch(order_id); }
+    
+    // Feed path - books addressed by ITCH stock_locate, no symbol strings
+    void submit_order(uint16_t stock_locate, uint64_t order_id, uint64_t timestamp,
+                     uint32_t price, uint32_t quantity, Side side, OrderType type);
+    
+    void cancel_order(uint16_t stock_locate, uint64_t order_id);
+    void modify_order(uint16_t stock_locate, uint64_t order_id, uint32_t new_quantity);
+    
     // Book access
-    OrderBook* get_book(const char* symbol);
+    OrderBook* get_book(const char* symbol) noexcept {
+        return get_book(symbols_.find(pack_symbol(symbol)));
+    }
+    OrderBook* get_book(SymbolId symbol) noexcept {
+        return symbol.valid() ? symbol_books_[symbol.index] : nullptr;
+    }
+    OrderBook* add_book(const char* symbol, const BookConfig& book_config);
+    
+    // Symbol directory. load_symbols() registers the day's universe (with
+    // default-config books) and rebuilds the perfect hash once.
+    SymbolId get_symbol_id(const char* symbol) const noexcept {
+        return symbols_.find(pack_symbol(symbol));
+    }
+    void load_symbols(const std::vector<std::string>& symbols);
+    
+    // Register a book under its stock_locate (from a Stock Directory message).
+    // A symbol already seen gets the locate mapped onto its existing book.
+    OrderBook* add_book(uint16_t stock_locate, const char* symbol,
+                        const BookConfig& book_config);
+    OrderBook* get_book(uint16_t stock_locate) const noexcept {
+        return locate_books_[stock_locate];
+    }
+    
+    // Execution reports. Pop them yourself or run the drain thread, not both.
+    SPSCQueue<ExecutionReport>& get_execution_queue() { return execution_queue_; }
+    
+    // Move spilled fills into the ring while it has room. Engine thread
+    // only. Returns the number still spilled.
+    size_t flush_executions() noexcept;
+    
+    // Consumer thread (pinned to cpu when >= 0) that pops fills in batches
+    // of up to DRAIN_BATCH and hands them to sink. Stopping it first flushes
+    // the spill, so every fill reaches sink; call it from the engine thread,
+    // or from any thread when an event loop runs - the loop is stopped first.
+    static constexpr size_t DRAIN_BATCH = 256;
     
-    // Execution reports
-    SPSCQueue<ExecutionReport, 65536>& get_execution_queue() { return execution_queue_; }
+    bool start_execution_drain(ExecutionSink sink, int cpu = -1);
+    void stop_execution_drain();
     
     // Statistics
     uint64_t get_total_orders() const noexcept { return total_orders_.load(); }
-    uint64_t get_total_matches() const noexcept { return total_matches_.load(); }
+    uint64_t get_total_matches() const noexcept { return total_matches_.load(); }  // Fills delivered
+    size_t get_orders_in_use() const noexcept { return order_pool_.in_use(); }  // Exact: no ThreadCache
+    size_t get_levels_in_use() const noexcept { return level_pool_.in_use(); }
     
-    // Control
+    // Failures counted instead of logged, so the matching path stays off stderr
+    uint64_t get_rejected_orders() const noexcept { return rejected_orders_.load(); }   // Pool exhausted, no book or id in use
+    uint64_t get_dropped_reports() const noexcept { return dropped_reports_.load(); }   // DROP policy
+    uint64_t get_spilled_reports() const noexcept { return spilled_reports_.load(); }   // SPILL policy, cumulative
+    
+    // Pools on explicit huge pages; false when they fell back to regular
+    // pages with a THP hint, or use_huge_page_arena is off
+    bool get_huge_pages() const noexcept { return arena_ && arena_->huge_pages(); }
+    
+    const EngineConfig& get_config() const noexcept { return config_; }
+    
+    // Control. With run_event_loop, start() launches the loop and stop()
+    // applies what is already queued, then joins it. Only the loop may
+    // touch the books while it runs.
     void start();
     void stop();
+    
+    // Post a command to the event loop from any thread. False when the
+    // ring is full or the engine runs without an event loop.
+    bool enqueue(const EngineCommand& command) noexcept;
     bool is_running() const noexcept { return running_.load(); }
     
 private:
     EngineConfig config_;
     
-    // Order books per symbol
-    std::unordered_map<std::string, std::unique_ptr<OrderBook>> books_;
+    // Huge-page arena backing the order and level pools
+    std::unique_ptr<HugePageArena> arena_;
+    
+    // Price levels for every book, grown chunk by chunk
+    PriceLevelPool level_pool_;
+    
+    // Resting orders of every book by id, maintained on add and release
+    OrderDirectory order_directory_;
     
-    // Order object pool (NUMA-aware allocation)
-    std::vector<Order*> order_pool_;
-    std::atomic<size_t> pool_index_;
+    // Order books, indexed by SymbolId and by stock_locate
+    std::vector<std::unique_ptr<OrderBook>> book_storage_;
+    SymbolDirectory symbols_;
+    std::vector<OrderBook*> symbol_books_;
+    std::vector<OrderBook*> locate_books_;
+    
+    // Order object pool (NUMA-aware allocation, LIFO recycling)
+    OrderPool order_pool_;
     
     // Execution queue
-    SPSCQueue<ExecutionReport, 65536> execution_queue_;
+    SPSCQueue<ExecutionReport> execution_queue_;
+    
+    // Fills that found the ring full under SPILL, oldest at spill_head_
+    std::vector<ExecutionReport> spill_;
+    size_t spill_head_ = 0;
     
     // Statistics
     std::atomic<uint64_t> total_orders_;
     std::atomic<uint64_t> total_matches_;
+    std::atomic<uint64_t> rejected_orders_{0};
+    std::atomic<uint64_t> dropped_reports_{0};
+    std::atomic<uint64_t> spilled_reports_{0};
+    
+    // Execution drain thread
+    ExecutionSink drain_sink_;
+    std::thread drain_thread_;
+    std::atomic<bool> draining_{false};
     
     // Threading
     std::atomic<bool> running_;
     
+    // Event loop
+    std::unique_ptr<IngressQueue> ingress_;
+    std::thread loop_thread_;
+    std::atomic<uint32_t> parked_{0};  // Futex word, 1 while the loop sleeps
+    
+    // Lookahead distances for submit_batch prefetch stages
+    static constexpr size_t PREFETCH_SLOTS_AHEAD = 8;
+    static constexpr size_t PREFETCH_OBJECTS_AHEAD = 6;
+    static constexpr size_t PREFETCH_LINKS_AHEAD = 4;
+    static constexpr size_t PREFETCH_LEVELS_AHEAD = 2;
+    
     // Helpers
+    void prefetch_slots(const EngineCommand& command) const noexcept;
+    void prefetch_objects(const EngineCommand& command) noexcept;
+    void prefetch_links(const EngineCommand& command) noexcept;
+    void prefetch_levels(const EngineCommand& command) noexcept;
+    void submit_to_book(OrderBook* book, uint64_t order_id, uint64_t timestamp,
+                        uint32_t price, uint32_t quantity, Side side, OrderType type);
+    OrderBook* create_book(const BookConfig& book_config);
+    OrderBook*& symbol_slot(SymbolId symbol);
+    Order* find_order(OrderBook* book, uint64_t order_id) noexcept;
+    bool push_report(const ExecutionReport& report);
+    bool push_report_full(const ExecutionReport& report);
+    void run_execution_drain(int cpu);
+    void run_loop();
+    void idle(unsigned& rounds);
+    void wake_loop() noexcept;
     Order* allocate_order();
     void deallocate_order(Order* order);
+    static void release_order(void* engine, Order* order);
     void setup_numa_affinity();
     void setup_cpu_affinity();
+    static std::unique_ptr<HugePageArena> make_arena(const EngineConfig& config);
 };
 
 } // namespace lob
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "order.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace lob {
+
+// Bounded lock-free multi-producer, single-consumer ring (Vyukov). Every
+// slot carries a sequence number: producers claim a position with one CAS
+// on the shared tail and publish by bumping the slot's sequence; the
+// consumer only reads sequences and never does a read-modify-write.
+//
+// Slots live on the heap, so large rings can sit inside other objects.
+template<typename T, size_t Capacity>
+class MPSCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
+    
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // Producers
+    alignas(CACHE_LINE_SIZE) size_t head_ = 0;              // Consumer only
+    alignas(CACHE_LINE_SIZE) std::unique_ptr<Slot[]> slots_;
+    
+public:
+    MPSCQueue() : slots_(new Slot[Capacity]) {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    // Disable copy and move
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+    
+    // Any thread
+    bool push(const T& item) noexcept {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos & (Capacity - 1)];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            
+            if (diff == 0) {
+                // Slot is free for this lap - try to claim it
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = item;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Queue full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Consumer thread only
+    bool pop(T& item) noexcept {
+        Slot& slot = slots_[head_ & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false; // Empty, or the claiming producer has not published yet
+        }
+        
+        item = slot.value;
+        slot.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+    
+    // Consumer thread only
+    size_t pop_n(T* items, size_t max_items) noexcept {
+        size_t count = 0;
+        while (count < max_items && pop(items[count])) ++count;
+        return count;
+    }
+    
+    // Consumer thread only; approximate while producers are active
+    size_t size() const noexcept {
+        return tail_.load(std::memory_order_relaxed) - head_;
+    }
+    
+    static constexpr size_t capacity() noexcept { return Capacity; }
+};
+
+} // namespace lob
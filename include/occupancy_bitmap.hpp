@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+namespace lob {
+
+// Three-level 64-bit occupancy bitmap (up to 64^3 = 262144 slots).
+// Each summary bit marks a non-empty word one level down, so finding the
+// next or previous occupied slot takes at most three tzcnt/lzcnt steps.
+class OccupancyBitmap {
+public:
+    static constexpr size_t MAX_BITS = 64 * 64 * 64;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    OccupancyBitmap() noexcept = default;
+
+    void init(size_t bits) {
+        bits = std::min(std::max<size_t>(bits, 1), MAX_BITS);
+        words_.assign((bits + 63) / 64, 0);
+        groups_.assign((words_.size() + 63) / 64, 0);
+        summary_ = 0;
+    }
+
+    void reset() noexcept {
+        std::fill(words_.begin(), words_.end(), 0);
+        std::fill(groups_.begin(), groups_.end(), 0);
+        summary_ = 0;
+    }
+
+    void set(size_t i) noexcept {
+        const size_t w = i >> 6;
+        words_[w] |= bit(i);
+        groups_[w >> 6] |= bit(w);
+        summary_ |= bit(w >> 6);
+    }
+
+    void clear(size_t i) noexcept {
+        const size_t w = i >> 6;
+        words_[w] &= ~bit(i);
+        if (words_[w] == 0) {
+            groups_[w >> 6] &= ~bit(w);
+            if (groups_[w >> 6] == 0) {
+                summary_ &= ~bit(w >> 6);
+            }
+        }
+    }
+
+    bool test(size_t i) const noexcept { return words_[i >> 6] & bit(i); }
+    bool empty() const noexcept { return summary_ == 0; }
+
+    // Lowest set bit at or above i, or npos
+    size_t find_next(size_t i) const noexcept {
+        size_t w = i >> 6;
+        if (w >= words_.size()) return npos;
+
+        uint64_t bits = words_[w] & (~0ULL << (i & 63));
+        if (bits) return (w << 6) + __builtin_ctzll(bits);
+
+        const size_t next_w = w + 1;
+        if (next_w >= words_.size()) return npos;
+        size_t g = next_w >> 6;
+        bits = groups_[g] & (~0ULL << (next_w & 63));
+        if (!bits) {
+            const size_t next_g = g + 1;
+            if (next_g >= groups_.size()) return npos;
+            bits = summary_ & (~0ULL << next_g);
+            if (!bits) return npos;
+            g = __builtin_ctzll(bits);
+            bits = groups_[g];
+        }
+        w = (g << 6) + __builtin_ctzll(bits);
+        return (w << 6) + __builtin_ctzll(words_[w]);
+    }
+
+    // Highest set bit at or below i, or npos
+    size_t find_prev(size_t i) const noexcept {
+        size_t w = i >> 6;
+        if (w >= words_.size()) {
+            w = words_.size() - 1;
+            i = (w << 6) + 63;
+        }
+
+        uint64_t bits = words_[w] & (~0ULL >> (63 - (i & 63)));
+        if (bits) return (w << 6) + 63 - __builtin_clzll(bits);
+
+        if (w == 0) return npos;
+        const size_t prev_w = w - 1;
+        size_t g = prev_w >> 6;
+        bits = groups_[g] & (~0ULL >> (63 - (prev_w & 63)));
+        if (!bits) {
+            if (g == 0) return npos;
+            bits = summary_ & (~0ULL >> (64 - g));
+            if (!bits) return npos;
+            g = 63 - __builtin_clzll(bits);
+            bits = groups_[g];
+        }
+        w = (g << 6) + 63 - __builtin_clzll(bits);
+        return (w << 6) + 63 - __builtin_clzll(words_[w]);
+    }
+
+    size_t size() const noexcept { return words_.size() * 64; }
+
+private:
+    static uint64_t bit(size_t i) noexcept { return 1ULL << (i & 63); }
+
+    std::vector<uint64_t> words_;   // Level 0: one bit per slot
+    std::vector<uint64_t> groups_;  // Level 1: one bit per non-empty word
+    uint64_t summary_ = 0;          // Level 2: one bit per non-empty group
+};
+
+} // namespace lob
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "order.hpp"
-#include <unordered_map>
+#include "price_ladder.hpp"
+#include "order_directory.hpp"
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <cstring>
 
 namespace lob {
 
+class HugePageArena;
+class PriceLevelPool;
+
 // Price level - doubly linked list of orders at same price
 class alignas(CACHE_LINE_SIZE) PriceLevel {
 public:
@@ -19,32 +24,108 @@ public:
     Order* head_order;
     Order* tail_order;
     
-    // Binary tree pointers for price levels
+    // Intrusive red-black tree links for price levels. Nodes are only
+    // ever relinked, never copied, so orders can hold on to their level.
     PriceLevel* parent;
     PriceLevel* left;
     PriceLevel* right;
+    bool is_red;
     
     explicit PriceLevel(uint32_t p) noexcept
         : price(p), total_volume(0), order_count(0),
           head_order(nullptr), tail_order(nullptr),
-          parent(nullptr), left(nullptr), right(nullptr) {}
+          parent(nullptr), left(nullptr), right(nullptr), is_red(false) {}
     
     void add_order(Order* order) noexcept;
     void remove_order(Order* order) noexcept;
 };
 
+// Price index backing each side of the book
+enum class PriceIndexType : uint8_t {
+    TREE = 0,    // Red-black tree of price levels
+    LADDER = 1   // Dense array indexed by (price - base) / tick, tree for outliers
+};
+
+// Called when a resting order leaves the book (fully filled or cancelled),
+// so whoever allocated it can recycle it
+using OrderReleaseFn = void (*)(void* context, Order* order);
+
+// Order book configuration
+struct BookConfig {
+    PriceIndexType price_index = PriceIndexType::TREE;
+    uint32_t tick_size = 100;      // Ladder tick in price units ($0.01 at 4 decimals)
+    uint32_t ladder_size = 4096;   // Ladder slots per side (at most 262144)
+    size_t order_capacity = 4096;  // Orders preallocated in the id table
+    OrderDirectoryType order_directory = OrderDirectoryType::HASH;
+    bool index_orders = true;      // Keep an id table (off when the owner indexes orders)
+    OrderReleaseFn release_fn = nullptr;
+    void* release_context = nullptr;
+    PriceLevelPool* level_pool = nullptr;  // Level pool shared across books, if any
+    size_t level_chunk_size = 4096;        // Levels per chunk of the book's own pool
+    HugePageArena* level_arena = nullptr;  // Carve the own pool's chunks from here, if set
+};
+
 // Main order book class
 class OrderBook {
 public:
     OrderBook();
+    explicit OrderBook(const BookConfig& config);
     ~OrderBook();
     
-    // Core operations
-    void add_order(Order* order);
+    // Core operations. The id-based calls need index_orders. add_order
+    // returns false if the order could not be placed (no price level).
+    bool add_order(Order* order);
     void cancel_order(uint64_t order_id);
     void modify_order(uint64_t order_id, uint32_t new_quantity);
     
-    // Matching
+    // The same operations on an order already looked up by the caller
+    void cancel_order(Order* order);
+    void modify_order(Order* order, uint32_t new_quantity) noexcept;
+    
+    // Take `quantity` off a resting order, removing it when nothing is left
+    void reduce_order(Order* order, uint32_t quantity);
+    
+    // Report an execution of `quantity` against a resting order at `price`
+    // (as printed by the exchange) and reduce it accordingly
+    ExecutionReport execute_order(Order* order, uint32_t quantity,
+                                  uint32_t price, uint64_t timestamp);
+    
+    // Pull the order's id-table slot into cache ahead of a cancel/modify
+    void prefetch_order(uint64_t order_id) const noexcept {
+        if (orders_) orders_->prefetch(order_id);
+    }
+    
+    // Pull in the book's own hot fields, then (once those are cached) the
+    // level slots an incoming order at `price` is likely to touch
+    void prefetch_book() const noexcept {
+        __builtin_prefetch(this, 0, 3);
+        __builtin_prefetch(&best_bid_, 0, 3);
+    }
+    void prefetch_level_slot(uint32_t price, Side side) const noexcept {
+        PriceLevel* contra = (side == Side::BUY) ? best_ask_ : best_bid_;
+        if (contra) __builtin_prefetch(contra, 1, 3);
+        if (ladder_mode()) {
+            const PriceLadder& ladder = (side == Side::BUY) ? bid_ladder_ : ask_ladder_;
+            if (ladder.covers(price)) ladder.prefetch(price);
+        } else {
+            PriceLevel* same = (side == Side::BUY) ? best_bid_ : best_ask_;
+            if (same) __builtin_prefetch(same, 1, 3);
+        }
+    }
+    
+    // Once prefetch_level_slot() has landed, pull in the ladder level itself
+    void prefetch_level(uint32_t price, Side side) const noexcept {
+        if (!ladder_mode()) return;
+        const PriceLadder& ladder = (side == Side::BUY) ? bid_ladder_ : ask_ladder_;
+        if (ladder.covers(price)) {
+            if (PriceLevel* level = ladder.get(price)) __builtin_prefetch(level, 1, 3);
+        }
+    }
+    
+    // Matching. The sink overload hands each fill to sink(const ExecutionReport&)
+    // as it happens and allocates nothing; the vector overload collects them.
+    template<typename Sink>
+    void match_order(Order* order, Sink&& sink);
     std::vector<ExecutionReport> match_order(Order* order);
     
     // Book state
@@ -59,21 +140,35 @@ public:
     uint64_t get_order_count() const noexcept { return order_count_; }
     uint64_t get_match_count() const noexcept { return match_count_; }
     
+    const BookConfig& get_config() const noexcept { return config_; }
+    
 private:
-    // Binary search trees for price levels
+    BookConfig config_;
+    
+    // Red-black trees for price levels (ladder overflow in LADDER mode)
     PriceLevel* bid_tree_root_;
     PriceLevel* ask_tree_root_;
     
+    // Price ladders - a level whose price is covered by the ladder window
+    // always lives in the ladder, everything else lives in the tree
+    PriceLadder bid_ladder_;
+    PriceLadder ask_ladder_;
+    
+    // Levels moving between ladder and tree during a recenter. Reserved
+    // for a full ladder at construction, so recentering (and matching
+    // through it) never allocates.
+    std::vector<PriceLevel*> recenter_scratch_;
+    
     // Best bid/ask pointers
     PriceLevel* best_bid_;
     PriceLevel* best_ask_;
     
-    // Order lookup
-    std::unordered_map<uint64_t, Order*> orders_;
+    // Order lookup (null without index_orders)
+    std::unique_ptr<OrderDirectory> orders_;
     
-    // Price level pool (pre-allocated)
-    std::vector<std::unique_ptr<PriceLevel>> price_level_pool_;
-    size_t pool_index_;
+    // Price level pool - points at own_levels_ unless the book shares one
+    std::unique_ptr<PriceLevelPool> own_levels_;
+    PriceLevelPool* levels_;
     
     // Statistics
     std::atomic<uint64_t> order_count_;
@@ -83,13 +178,97 @@ private:
     PriceLevel* find_or_create_level(uint32_t price, Side side);
     PriceLevel* find_level(uint32_t price, PriceLevel* root);
     PriceLevel* insert_level(uint32_t price, PriceLevel*& root);
+    void link_level(PriceLevel* level, PriceLevel*& root);
     void remove_level(PriceLevel* level, PriceLevel*& root);
+    void detach_level(PriceLevel* level, Side side);
     void update_best_bid();
     void update_best_ask();
     
+    // Ladder helpers
+    bool ladder_mode() const noexcept { return config_.price_index == PriceIndexType::LADDER; }
+    PriceLevel* allocate_level(uint32_t price);
+    void free_level(PriceLevel* level) noexcept;
+    void recenter_ladder(Side side, uint32_t center);
+    
+    void release_order(Order* order) noexcept {
+        order->book = nullptr;
+        if (config_.release_fn) config_.release_fn(config_.release_context, order);
+    }
+    
     // Matching helpers
     ExecutionReport execute_trade(Order* aggressive, Order* passive, 
-                                  uint32_t quantity, uint64_t match_id);
+                                  uint32_t quantity, uint64_t match_id) const noexcept {
+        return ExecutionReport(
+            aggressive->order_id,
+            match_id,
+            aggressive->timestamp,
+            passive->price, // Trade at passive price
+            quantity,
+            aggressive->side,
+            aggressive->remaining_quantity == quantity
+        );
+    }
 };
 
+template<typename Sink>
+void OrderBook::match_order(Order* order, Sink&& sink) {
+    if (order->type != OrderType::LIMIT && order->type != OrderType::MARKET) {
+        return;
+    }
+    
+    PriceLevel* contra_level = (order->side == Side::BUY) ? best_ask_ : best_bid_;
+    
+    while (order->remaining_quantity > 0 && contra_level) {
+        // Check price crossing
+        if (order->type == OrderType::LIMIT) {
+            if (order->side == Side::BUY && order->price < contra_level->price) break;
+            if (order->side == Side::SELL && order->price > contra_level->price) break;
+        }
+        
+        Order* passive = contra_level->head_order;
+        while (passive && order->remaining_quantity > 0) {
+            uint32_t match_qty = std::min(order->remaining_quantity, 
+                                         passive->remaining_quantity);
+            
+            // Generate execution report
+            uint64_t match_id = ++match_count_;
+            sink(execute_trade(order, passive, match_qty, match_id));
+            
+            // Update quantities
+            order->remaining_quantity -= match_qty;
+            passive->remaining_quantity -= match_qty;
+            contra_level->total_volume -= match_qty;
+            
+            Order* next_passive = passive->next;
+            
+            // Remove fully filled passive order
+            if (passive->remaining_quantity == 0) {
+                contra_level->remove_order(passive);
+                if (orders_) orders_->extract(passive->order_id);
+                --order_count_;
+                release_order(passive);
+            }
+            
+            passive = next_passive;
+        }
+        
+        // Move to next price level if current is depleted
+        if (contra_level->order_count == 0) {
+            PriceLevel* empty_level = contra_level;
+            if (order->side == Side::BUY) {
+                detach_level(empty_level, Side::SELL);
+                update_best_ask();
+                contra_level = best_ask_;
+            } else {
+                detach_level(empty_level, Side::BUY);
+                update_best_bid();
+                contra_level = best_bid_;
+            }
+            free_level(empty_level);
+        } else {
+            break;
+        }
+    }
+}
+
 } // namespace lob
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "order.hpp"
+#include "flat_hash_map.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+namespace lob {
+
+// Order id index implementation
+enum class OrderDirectoryType : uint8_t {
+    HASH = 0,    // Flat hash table
+    DIRECT = 1   // Sliding window indexed by id, hash fallback for stragglers
+};
+
+// Dense table for ids that are assigned (almost) sequentially, such as ITCH
+// order reference numbers. Ids inside [base, base + window) are stored at
+// slot id & (window - 1); the window slides forward as new ids arrive and
+// evicts anything it leaves behind into a hash table, which also takes ids
+// that show up below the window. A value-initialized V marks an empty slot.
+//
+// Sliding is incremental: each insert scrubs at most MAX_EVICT_PER_INSERT
+// slots off the bottom, so one insert never stalls on a large window. Ids
+// that arrive ahead of the window while it catches up go to the hash
+// table, and window lookups that miss fall back to it.
+template<typename V>
+class DirectOrderTable {
+public:
+    static constexpr size_t MAX_EVICT_PER_INSERT = 64;
+
+    DirectOrderTable() noexcept = default;
+
+    explicit DirectOrderTable(size_t window) { init(window); }
+
+    // Disable copy and move
+    DirectOrderTable(const DirectOrderTable&) = delete;
+    DirectOrderTable& operator=(const DirectOrderTable&) = delete;
+
+    void init(size_t window) {
+        size_t slots = 64;
+        while (slots < window) slots <<= 1;
+        slots_.assign(slots, V{});
+        mask_ = slots - 1;
+        base_ = 0;
+        live_ = 0;
+        fallback_.clear();
+    }
+
+    V* find(uint64_t id) noexcept {
+        if (in_window(id)) {
+            V& slot = slots_[id & mask_];
+            if (slot != V{}) return &slot;
+            if (fallback_.size() == 0) return nullptr;
+        }
+        return fallback_.find(id);
+    }
+
+    void insert(uint64_t id, const V& value) {
+        if (id >= base_ && id - base_ >= slots_.size() * 3 / 4) {
+            slide(id);
+        }
+        if (in_window(id)) {
+            V& slot = slots_[id & mask_];
+            if (slot == V{}) ++live_;
+            slot = value;
+        } else {
+            fallback_.insert(id, value);
+        }
+    }
+
+    bool extract(uint64_t id, V& out) noexcept {
+        if (in_window(id)) {
+            V& slot = slots_[id & mask_];
+            if (slot != V{}) {
+                out = slot;
+                slot = V{};
+                --live_;
+                return true;
+            }
+            if (fallback_.size() == 0) return false;
+        }
+        return fallback_.extract(id, out);
+    }
+
+    void prefetch(uint64_t id) const noexcept {
+        if (in_window(id)) {
+            __builtin_prefetch(&slots_[id & mask_], 0, 3);
+        } else {
+            fallback_.prefetch(id);
+        }
+    }
+
+    size_t size() const noexcept { return live_ + fallback_.size(); }
+    size_t fallback_size() const noexcept { return fallback_.size(); }
+    uint64_t window_base() const noexcept { return base_; }
+
+private:
+    std::vector<V> slots_;
+    size_t mask_ = 0;
+    uint64_t base_ = 0;
+    size_t live_ = 0;
+    FlatHashMap<V> fallback_{1024};
+
+    bool in_window(uint64_t id) const noexcept { return id - base_ < slots_.size(); }
+
+    // Move the window toward putting `id` three quarters of the way in,
+    // spilling live entries that fall off the bottom into the fallback
+    // table. Scrubs at most MAX_EVICT_PER_INSERT slots; later inserts
+    // carry on from base_.
+    void slide(uint64_t id) {
+        const uint64_t target = id - (slots_.size() * 3 / 4);
+        if (live_ == 0) {
+            base_ = target;  // Nothing left to evict
+            return;
+        }
+
+        const uint64_t evict_end = std::min<uint64_t>(target, base_ + MAX_EVICT_PER_INSERT);
+        for (; base_ < evict_end && live_ > 0; ++base_) {
+            V& slot = slots_[base_ & mask_];
+            if (slot != V{}) {
+                fallback_.insert(base_, slot);
+                slot = V{};
+                --live_;
+            }
+        }
+        if (live_ == 0) base_ = target;
+    }
+};
+
+// Order id -> Order* index used by the books. Either a flat hash table or,
+// for feeds with near-sequential ids, a direct-indexed table.
+class OrderDirectory {
+public:
+    explicit OrderDirectory(OrderDirectoryType type = OrderDirectoryType::HASH,
+                            size_t capacity = 4096)
+        : type_(type), hash_(type == OrderDirectoryType::HASH ? capacity : 16) {
+        if (type_ == OrderDirectoryType::DIRECT) {
+            direct_.init(capacity);
+        }
+    }
+
+    Order* find(uint64_t order_id) noexcept {
+        Order** slot = (type_ == OrderDirectoryType::DIRECT)
+            ? direct_.find(order_id) : hash_.find(order_id);
+        return slot ? *slot : nullptr;
+    }
+
+    void insert(uint64_t order_id, Order* order) {
+        if (type_ == OrderDirectoryType::DIRECT) {
+            direct_.insert(order_id, order);
+        } else {
+            hash_.insert(order_id, order);
+        }
+    }
+
+    // Remove and return the order, or nullptr if the id is unknown
+    Order* extract(uint64_t order_id) noexcept {
+        Order* order = nullptr;
+        if (type_ == OrderDirectoryType::DIRECT) {
+            direct_.extract(order_id, order);
+        } else {
+            hash_.extract(order_id, order);
+        }
+        return order;
+    }
+
+    // Remove order_id only while it still maps to `order`
+    bool erase(uint64_t order_id, const Order* order) noexcept {
+        if (find(order_id) != order) return false;
+        extract(order_id);
+        return true;
+    }
+
+    void prefetch(uint64_t order_id) const noexcept {
+        if (type_ == OrderDirectoryType::DIRECT) {
+            direct_.prefetch(order_id);
+        } else {
+            hash_.prefetch(order_id);
+        }
+    }
+
+    size_t size() const noexcept {
+        return (type_ == OrderDirectoryType::DIRECT) ? direct_.size() : hash_.size();
+    }
+
+    OrderDirectoryType type() const noexcept { return type_; }
+
+private:
+    OrderDirectoryType type_;
+    FlatHashMap<Order*> hash_;
+    DirectOrderTable<Order*> direct_;
+};
+
+} // namespace lob
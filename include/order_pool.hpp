@@ -0,0 +1,119 @@
+#pragma once
+
+#include "order.hpp"
+#include <atomic>
+#include <cstddef>
+
+namespace lob {
+
+class HugePageArena;
+
+// Fixed-capacity Order pool with an intrusive LIFO free list threaded
+// through Order::next. The most recently freed slot is handed out first,
+// so hot orders are reused while still in cache.
+//
+// Orders live in one contiguous slab, carved from a HugePageArena when one
+// is supplied and from the heap otherwise.
+//
+// allocate()/deallocate() are single-threaded. Threads sharing one pool
+// each go through their own ThreadCache, which moves orders to and from
+// the shared free list in batches under a spinlock.
+class OrderPool {
+public:
+    explicit OrderPool(size_t capacity, HugePageArena* arena = nullptr);
+    ~OrderPool();
+
+    // Disable copy and move
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    Order* allocate() noexcept {
+        Order* order = free_list_;
+        if (order) {
+            free_list_ = order->next;
+            order->next = nullptr;
+        } else if (next_unused_ < capacity_) {
+            order = &slab_[next_unused_++];
+        } else {
+            return nullptr;
+        }
+        ++in_use_;
+        return order;
+    }
+
+    void deallocate(Order* order) noexcept {
+        order->prev = nullptr;
+        order->parent_level = nullptr;
+        order->next = free_list_;
+        free_list_ = order;
+        --in_use_;
+    }
+
+    size_t capacity() const noexcept { return capacity_; }
+    // Counts orders out of the shared free list, including those parked
+    // in a ThreadCache; subtract ThreadCache::cached() for live orders
+    size_t in_use() const noexcept { return in_use_; }
+    size_t high_water() const noexcept { return next_unused_; }
+
+    // Per-thread front end for a pool shared between threads
+    class ThreadCache {
+    public:
+        explicit ThreadCache(OrderPool& pool, size_t batch = 64) noexcept
+            : pool_(pool), head_(nullptr), count_(0), batch_(batch ? batch : 1) {}
+        ~ThreadCache();
+
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        Order* allocate() noexcept {
+            if (!head_) {
+                count_ = pool_.take_batch(head_, batch_);
+                if (!head_) return nullptr;
+            }
+            Order* order = head_;
+            head_ = order->next;
+            order->next = nullptr;
+            --count_;
+            return order;
+        }
+
+        void deallocate(Order* order) noexcept {
+            order->prev = nullptr;
+            order->parent_level = nullptr;
+            order->next = head_;
+            head_ = order;
+            if (++count_ >= batch_ * 2) {
+                flush(batch_);
+            }
+        }
+
+        size_t cached() const noexcept { return count_; }
+
+    private:
+        OrderPool& pool_;
+        Order* head_;
+        size_t count_;
+        size_t batch_;
+
+        void flush(size_t keep) noexcept;
+    };
+
+private:
+    Order* slab_;
+    size_t capacity_;
+    bool owns_slab_;
+
+    Order* free_list_ = nullptr;
+    size_t next_unused_ = 0;
+    size_t in_use_ = 0;
+
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+
+    // Shared-side batch transfers used by ThreadCache
+    size_t take_batch(Order*& head, size_t max_count) noexcept;
+    void give_batch(Order* head, Order* tail, size_t count) noexcept;
+    void lock() noexcept;
+    void unlock() noexcept { lock_.clear(std::memory_order_release); }
+};
+
+} // namespace lob
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "matching_engine.hpp"
+#include "feed_handler.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace lob {
+
+// Partitioned replay configuration
+struct PartitionedReplayConfig {
+    size_t num_partitions = 4;
+    std::vector<int> partition_cores;  // Core per partition; empty = no pinning
+    EngineConfig engine_config;        // Per partition (pool sizes are per partition too)
+};
+
+// Replay counters for one partition, or all of them merged
+struct ReplayStats {
+    uint64_t messages = 0;
+    uint64_t total_orders = 0;
+    uint64_t total_matches = 0;
+    uint64_t rejected_orders = 0;
+    uint64_t resting_orders = 0;   // Orders still on the books at the end
+    TradeStats trades;
+    uint64_t elapsed_ns = 0;       // Merged: wall time of the whole replay
+
+    ReplayStats& operator+=(const ReplayStats& other) noexcept;
+};
+
+// Replays one ITCH file on num_partitions threads. Messages are split by
+// stock_locate (locate % num_partitions), so every symbol's messages are
+// decoded and applied by one thread, in file order, against books that
+// thread owns outright.
+//
+// Without an index the calling thread routes: it walks the message
+// framing, reads each locate and passes message offsets to the partitions
+// through SPSC rings, and the partitions do the decoding. build_index runs
+// that routing once and saves the per-partition offset lists, so later
+// replays with the same partition count map the index and every partition
+// walks its own list with no router at all.
+class PartitionedReplay {
+public:
+    static constexpr size_t ROUTE_RING_SIZE = 65536;  // Offsets per partition
+    static constexpr size_t ROUTE_BATCH = 64;         // Offsets per push
+
+    explicit PartitionedReplay(const PartitionedReplayConfig& config);
+    ~PartitionedReplay();
+
+    // Disable copy and move
+    PartitionedReplay(const PartitionedReplay&) = delete;
+    PartitionedReplay& operator=(const PartitionedReplay&) = delete;
+
+    // Replay filename into the partitions' books. With an index_path that
+    // build_index wrote for this file and partition count the router is
+    // skipped; a missing or mismatched index falls back to routing.
+    // Returns false if the file cannot be read.
+    bool replay(const std::string& filename, const std::string& index_path = "");
+
+    // Pre-pass: write the per-partition message offsets of filename to
+    // index_path. Returns false on I/O failure.
+    static bool build_index(const std::string& filename, size_t num_partitions,
+                            const std::string& index_path);
+
+    size_t partition_of(uint16_t stock_locate) const noexcept {
+        return stock_locate % partitions_.size();
+    }
+    size_t num_partitions() const noexcept { return partitions_.size(); }
+
+    // Partition engines - only touch their books between replays
+    MatchingEngine& engine(size_t index) noexcept { return *partitions_[index]->engine; }
+
+    // Counters accumulate over every replay; elapsed_ns covers the last
+    // one. Per partition, and merged at the end of each replay.
+    const ReplayStats& get_partition_stats(size_t index) const noexcept {
+        return partitions_[index]->stats;
+    }
+    const ReplayStats& get_stats() const noexcept { return stats_; }
+
+private:
+    struct Partition {
+        SPSCQueue<uint64_t> offsets{ROUTE_RING_SIZE};
+        std::unique_ptr<MatchingEngine> engine;
+        std::unique_ptr<FeedHandler> feed;
+        std::thread worker;
+        ReplayStats stats;
+    };
+
+    PartitionedReplayConfig config_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    std::atomic<bool> routed_{false};  // Router has pushed every offset
+    ReplayStats stats_;
+
+    void run_routed(size_t index, const uint8_t* data, size_t size);
+    void run_indexed(size_t index, const uint8_t* data, size_t size,
+                     const uint64_t* offsets, size_t count);
+    void pin_partition(size_t index) const;
+    void collect_stats(size_t index, uint64_t elapsed_ns);
+};
+
+} // namespace lob
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include "occupancy_bitmap.hpp"
+
+namespace lob {
+
+class PriceLevel;
+
+// Dense array of price level slots for one side of the book.
+// Slot i holds the level at price base + i * tick. The window can be
+// recentered when the book drifts; levels are referenced by pointer so
+// they never move when the window does. An occupancy bitmap makes finding
+// the next non-empty slot constant-time.
+class PriceLadder {
+public:
+    PriceLadder() noexcept = default;
+
+    void init(uint32_t tick, uint32_t size) {
+        tick_ = tick ? tick : 1;
+        size = std::min<uint32_t>(std::max<uint32_t>(size, 1), OccupancyBitmap::MAX_BITS);
+        slots_.assign(size, nullptr);
+        occupied_.init(size);
+        base_ = 0;
+        count_ = 0;
+    }
+
+    // True if the price falls on a slot of the current window
+    bool covers(uint32_t price) const noexcept {
+        if (price < base_) return false;
+        const uint32_t offset = price - base_;
+        const uint32_t idx = offset / tick_;
+        return idx < slots_.size() && idx * tick_ == offset;
+    }
+
+    size_t index_of(uint32_t price) const noexcept { return (price - base_) / tick_; }
+    uint32_t price_at(size_t idx) const noexcept {
+        return base_ + static_cast<uint32_t>(idx) * tick_;
+    }
+
+    PriceLevel* get(uint32_t price) const noexcept { return slots_[index_of(price)]; }
+    void prefetch(uint32_t price) const noexcept { __builtin_prefetch(&slots_[index_of(price)], 0, 3); }
+    PriceLevel* at(size_t idx) const noexcept { return slots_[idx]; }
+
+    void set(uint32_t price, PriceLevel* level) noexcept {
+        const size_t idx = index_of(price);
+        slots_[idx] = level;
+        occupied_.set(idx);
+        ++count_;
+    }
+
+    void clear(uint32_t price) noexcept {
+        const size_t idx = index_of(price);
+        slots_[idx] = nullptr;
+        occupied_.clear(idx);
+        --count_;
+    }
+
+    // Highest occupied slot at or below `price` (price must be covered)
+    PriceLevel* highest_at_or_below(uint32_t price) const noexcept {
+        const size_t idx = occupied_.find_prev(index_of(price));
+        return (idx != OccupancyBitmap::npos) ? slots_[idx] : nullptr;
+    }
+
+    // Lowest occupied slot at or above `price` (price must be covered)
+    PriceLevel* lowest_at_or_above(uint32_t price) const noexcept {
+        const size_t idx = occupied_.find_next(index_of(price));
+        return (idx != OccupancyBitmap::npos) ? slots_[idx] : nullptr;
+    }
+
+    // Next occupied slot index at or after idx, or OccupancyBitmap::npos
+    size_t next_occupied(size_t idx) const noexcept { return occupied_.find_next(idx); }
+
+    PriceLevel* highest() const noexcept {
+        return highest_at_or_below(price_at(slots_.size() - 1));
+    }
+
+    PriceLevel* lowest() const noexcept { return lowest_at_or_above(base_); }
+
+    // Clear all slots and move the window so that `center` sits in the
+    // middle slot, aligned to the center price. Callers migrate levels.
+    void recenter(uint32_t center) noexcept {
+        std::fill(slots_.begin(), slots_.end(), nullptr);
+        occupied_.reset();
+        count_ = 0;
+        const uint32_t half = static_cast<uint32_t>(slots_.size() / 2);
+        const uint32_t steps = std::min(half, center / tick_);
+        base_ = center - steps * tick_;
+    }
+
+    uint32_t base() const noexcept { return base_; }
+    uint32_t tick() const noexcept { return tick_; }
+    size_t size() const noexcept { return slots_.size(); }
+    size_t level_count() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+
+private:
+    std::vector<PriceLevel*> slots_;
+    OccupancyBitmap occupied_;
+    uint32_t base_ = 0;
+    uint32_t tick_ = 1;
+    size_t count_ = 0;
+};
+
+} // namespace lob
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "matching_engine.hpp"
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace lob {
+
+// Sharded engine configuration
+struct ShardedEngineConfig {
+    size_t num_shards = 4;
+    std::vector<int> shard_cores;  // Core per shard; empty = no pinning
+    EngineConfig engine_config;    // Per shard (pool sizes are per shard too)
+};
+
+// Runs one MatchingEngine per shard, each on its own worker thread.
+// Books are assigned to shards by stock_locate, so a shard owns its books
+// outright and no book is ever touched by two threads. A single router
+// thread feeds the shards through per-shard SPSC command rings; each shard
+// publishes fills on its own execution ring.
+class ShardedEngine {
+public:
+    static constexpr size_t COMMAND_RING_SIZE = 65536;
+    static constexpr size_t WORKER_BATCH = 64;  // Commands per submit_batch
+
+    explicit ShardedEngine(const ShardedEngineConfig& config);
+    ~ShardedEngine();
+
+    // Disable copy and move
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    // Router side - call from one thread only. Spins while the ring is full.
+    void submit(const EngineCommand& command) noexcept;
+
+    // Wait until every submitted command has been applied
+    void drain() const noexcept;
+
+    size_t shard_of(uint16_t stock_locate) const noexcept {
+        return stock_locate % shards_.size();
+    }
+    size_t num_shards() const noexcept { return shards_.size(); }
+
+    // Shard engines - only touch their books from the router once drained
+    MatchingEngine& shard(size_t index) noexcept { return *shards_[index]->engine; }
+
+    // Pop up to max_reports fills from every shard's execution ring
+    template<typename Fn>
+    size_t poll_executions(Fn&& on_report, size_t max_reports = ~size_t{0}) {
+        size_t count = 0;
+        ExecutionReport report;
+        for (auto& shard : shards_) {
+            auto& ring = shard->engine->get_execution_queue();
+            while (count < max_reports && ring.pop(report)) {
+                on_report(report);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    uint64_t get_total_orders() const noexcept;
+    uint64_t get_total_matches() const noexcept;
+
+    void stop();
+
+private:
+    struct Shard {
+        SPSCQueue<EngineCommand> commands{COMMAND_RING_SIZE};
+        std::unique_ptr<MatchingEngine> engine;
+        std::thread worker;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> applied{0};
+        alignas(CACHE_LINE_SIZE) uint64_t submitted = 0;  // Router only
+        std::atomic<bool> ready{false};
+    };
+
+    ShardedEngineConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_;
+
+    void run_shard(size_t index);
+};
+
+} // namespace lob
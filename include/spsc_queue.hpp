@@ -0,0 +1,207 @@
+#pragma once
+
+#include "order.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace lob {
+
+// Capacity of an SPSCQueue sized at construction
+constexpr size_t DYNAMIC_CAPACITY = 0;
+
+namespace detail {
+
+// Ring slots held inline in the queue object
+template<typename T, size_t Capacity>
+class RingStorage {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of 2");
+
+public:
+    static constexpr size_t capacity() noexcept { return Capacity; }
+    static constexpr bool huge_pages() noexcept { return false; }
+    T* slots() noexcept { return buffer_.data(); }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_;
+};
+
+// Ring slots in their own huge-page mapping, capacity rounded up to a
+// power of 2. Every slot is constructed (and its page faulted in) here.
+template<typename T>
+class RingStorage<T, DYNAMIC_CAPACITY> {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Slots are unmapped without running destructors");
+
+public:
+    explicit RingStorage(size_t capacity) : capacity_(2) {
+        while (capacity_ < capacity) capacity_ <<= 1;
+        bytes_ = (capacity_ * sizeof(T) + HugePageArena::HUGE_PAGE_SIZE - 1) &
+                 ~(HugePageArena::HUGE_PAGE_SIZE - 1);
+        buffer_ = static_cast<T*>(allocate_huge_pages(bytes_, &huge_pages_));
+        if (!buffer_) throw std::bad_alloc();
+        for (size_t i = 0; i < capacity_; ++i) new (&buffer_[i]) T();
+    }
+
+    ~RingStorage() { deallocate_huge_pages(buffer_, bytes_); }
+
+    RingStorage(const RingStorage&) = delete;
+    RingStorage& operator=(const RingStorage&) = delete;
+
+    size_t capacity() const noexcept { return capacity_; }
+    bool huge_pages() const noexcept { return huge_pages_; }
+    T* slots() noexcept { return buffer_; }
+
+private:
+    T* buffer_;
+    size_t capacity_;
+    size_t bytes_;
+    bool huge_pages_ = false;
+};
+
+} // namespace detail
+
+// Lock-free single-producer, single-consumer ring. head_ and tail_ count
+// every push and pop, so all Capacity slots are usable. Each side keeps a
+// private copy of the other side's index and only reloads the shared one
+// when its copy says the ring is full (or empty), so the common case
+// touches no cache line the other core writes.
+//
+// SPSCQueue<T, N> holds its slots inline; SPSCQueue<T> takes the capacity
+// at construction and maps the slots from huge pages, which keeps large
+// rings out of the objects that own them.
+template<typename T, size_t Capacity = DYNAMIC_CAPACITY>
+class alignas(CACHE_LINE_SIZE) SPSCQueue {
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  // Written by producer
+    size_t cached_tail_ = 0;                                 // Producer's view of tail_
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // Written by consumer
+    size_t cached_head_ = 0;                                 // Consumer's view of head_
+    alignas(CACHE_LINE_SIZE) detail::RingStorage<T, Capacity> storage_;
+
+    size_t mask() const noexcept { return storage_.capacity() - 1; }
+
+public:
+    SPSCQueue() noexcept = default;
+    explicit SPSCQueue(size_t capacity) : storage_(capacity) {}
+
+    // Disable copy and move
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer side
+
+    bool push(const T& item) noexcept {
+        T* slot = reserve();
+        if (!slot) {
+            return false; // Queue full
+        }
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    // Next free slot to build an entry in place, or nullptr when full.
+    // The entry becomes visible to the consumer on commit().
+    T* reserve() noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ == storage_.capacity()) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ == storage_.capacity()) {
+                return nullptr;
+            }
+        }
+        return &storage_.slots()[head & mask()];
+    }
+
+    void commit() noexcept {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Push as many of items as fit, published together. Returns the count.
+    size_t push_n(const T* items, size_t count) noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (storage_.capacity() - (head - cached_tail_) < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t room = storage_.capacity() - (head - cached_tail_);
+        if (count > room) count = room;
+
+        T* slots = storage_.slots();
+        for (size_t i = 0; i < count; ++i) {
+            slots[(head + i) & mask()] = items[i];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+
+    bool pop(T& item) noexcept {
+        const T* slot = front();
+        if (!slot) {
+            return false; // Queue empty
+        }
+        item = *slot;
+        pop();
+        return true;
+    }
+
+    // Oldest entry, read in place, or nullptr when empty. pop() releases
+    // its slot back to the producer.
+    const T* front() noexcept {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return nullptr;
+            }
+        }
+        return &storage_.slots()[tail & mask()];
+    }
+
+    void pop() noexcept {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Pop up to max_items into items, releasing their slots together.
+    // Returns the count.
+    size_t pop_n(T* items, size_t max_items) noexcept {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (cached_head_ - tail < max_items) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        const size_t available = cached_head_ - tail;
+        const size_t count = (max_items < available) ? max_items : available;
+
+        const T* slots = storage_.slots();
+        for (size_t i = 0; i < count; ++i) {
+            items[i] = slots[(tail + i) & mask()];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Either side; approximate while the other side is active
+
+    bool empty() const noexcept {
+        return tail_.load(std::memory_order_acquire) ==
+               head_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const noexcept {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    size_t capacity() const noexcept { return storage_.capacity(); }
+
+    // Slots on explicit huge pages (false when they fell back to regular
+    // pages, or are held inline)
+    bool huge_pages() const noexcept { return storage_.huge_pages(); }
+};
+
+} // namespace lob
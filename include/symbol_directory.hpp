@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace lob {
+
+// Symbols are at most 8 characters (ITCH pads them with spaces to exactly
+// 8), so a symbol packs into one little-endian uint64_t with the padding
+// zeroed. The empty symbol packs to 0.
+using SymbolKey = uint64_t;
+
+// Dense id assigned by SymbolDirectory, in registration order
+struct SymbolId {
+    static constexpr uint32_t INVALID_INDEX = ~0u;
+
+    uint32_t index = INVALID_INDEX;
+
+    bool valid() const noexcept { return index != INVALID_INDEX; }
+};
+
+namespace detail {
+
+// Bit i set when byte i is a space or NUL
+inline uint32_t padding_mask(uint64_t raw) noexcept {
+#ifdef __SSE2__
+    const __m128i bytes = _mm_cvtsi64_si128(static_cast<long long>(raw));
+    const __m128i pad = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                     _mm_cmpeq_epi8(bytes, _mm_setzero_si128()));
+    return static_cast<uint32_t>(_mm_movemask_epi8(pad)) & 0xFF;
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 8; ++i) {
+        const uint8_t c = static_cast<uint8_t>(raw >> (i * 8));
+        if (c == ' ' || c == 0) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// Zero every byte after the last non-padding byte
+inline SymbolKey trim_padding(uint64_t raw) noexcept {
+    const uint32_t data = ~padding_mask(raw) & 0xFF;
+    if (!data) return 0;
+    const int last = 31 - __builtin_clz(data);
+    return (last == 7) ? raw : raw & ((1ULL << (8 * (last + 1))) - 1);
+}
+
+} // namespace detail
+
+// Pack an ITCH stock field (exactly 8 bytes, space padded)
+inline SymbolKey pack_itch_symbol(const char* field) noexcept {
+    uint64_t raw;
+    std::memcpy(&raw, field, sizeof(raw));
+    return detail::trim_padding(raw);
+}
+
+// Pack a NUL-terminated symbol. One longer than 8 characters cannot be
+// packed without colliding with others and packs to 0, the empty symbol,
+// which no book is registered under.
+inline SymbolKey pack_symbol(const char* symbol) noexcept {
+    const size_t length = strnlen(symbol, sizeof(SymbolKey) + 1);
+    if (length > sizeof(SymbolKey)) return 0;
+
+    // Never reads past the NUL
+    uint64_t raw = 0;
+    std::memcpy(&raw, symbol, length);
+    return detail::trim_padding(raw);
+}
+
+// SymbolKey -> SymbolId perfect hash (hash and displace). Keys are split
+// into buckets, and each bucket gets a seed chosen at build time so that
+// all keys land in distinct slots. A lookup is one bucket-seed read plus
+// one slot compare, with no probing.
+//
+// rebuild() runs when the symbol universe is loaded. A symbol added later
+// goes into its free slot when it has one and triggers a rebuild when not,
+// which is fine for the handful of symbols that show up intraday.
+class SymbolDirectory {
+public:
+    SymbolDirectory() { rebuild(); }
+
+    // Disable copy and move
+    SymbolDirectory(const SymbolDirectory&) = delete;
+    SymbolDirectory& operator=(const SymbolDirectory&) = delete;
+
+    SymbolId find(SymbolKey key) const noexcept {
+        const Slot& slot = slots_[slot_of(key, seeds_[bucket_of(key)])];
+        return (slot.key == key && key != 0) ? SymbolId{slot.id} : SymbolId{};
+    }
+
+    // Returns the existing id for a known key
+    SymbolId insert(SymbolKey key);
+
+    // Register a batch of symbols (the day's universe) with one rebuild
+    void load(const std::vector<SymbolKey>& keys);
+
+    SymbolKey key_of(SymbolId id) const noexcept { return keys_[id.index]; }
+    size_t size() const noexcept { return keys_.size(); }
+    size_t capacity() const noexcept { return slots_.size(); }
+    size_t rebuild_count() const noexcept { return rebuilds_; }
+
+private:
+    struct Slot {
+        SymbolKey key = 0;   // 0 marks an empty slot
+        uint32_t id = 0;
+    };
+
+    std::vector<SymbolKey> keys_;   // Indexed by SymbolId
+    std::vector<uint32_t> seeds_;   // Per bucket
+    std::vector<Slot> slots_;
+    uint32_t slot_bits_ = 0;
+    uint32_t bucket_bits_ = 0;
+    size_t rebuilds_ = 0;
+
+    size_t bucket_of(SymbolKey key) const noexcept {
+        return (key * 0xC2B2AE3D27D4EB4FULL) >> (63 - bucket_bits_) >> 1;
+    }
+
+    size_t slot_of(SymbolKey key, uint32_t seed) const noexcept {
+        const uint64_t h = (key ^ (seed * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+        return (h ^ (h >> 29)) >> (63 - slot_bits_) >> 1;
+    }
+
+    void rebuild();
+    bool try_build(uint32_t slot_bits);
+};
+
+} // namespace lob
@@ -7,6 +7,7 @@
 #include <atomic>        // ADD THIS
 #include <vector>        // ADD THIS
 #include <cstring>
+#include <thread>
 
 namespace lob {
 
@@ -33,14 +34,68 @@ inline void compiler_barrier() noexcept {
     __asm__ __volatile__("" ::: "memory");
 }
 
+// Idle step for polling loops: call n pauses 2^n times, up to
+// 2^max_shift, and later calls yield the core in case the thread being
+// waited on shares it. Reset rounds to 0 after useful work.
+inline void backoff(unsigned& rounds, unsigned max_shift = 10) noexcept {
+    if (rounds <= max_shift) {
+        for (unsigned i = 0; i < (1u << rounds); ++i) __builtin_ia32_pause();
+        ++rounds;
+    } else {
+        std::this_thread::yield();
+    }
+}
+
 // CPU affinity
 void set_cpu_affinity(int cpu);
 void set_numa_node(int node);
 
-// Huge pages
-void* allocate_huge_pages(size_t size);
+// Huge pages. Explicit (hugetlbfs) pages when the system has them, else
+// regular pages with a transparent huge page hint; huge_pages, if given,
+// says which. reserve_only maps with MAP_NORESERVE, so nothing is
+// committed until commit_pages (or a first touch). numa_node >= 0 binds
+// the range before any page of it is faulted in.
+void* allocate_huge_pages(size_t size, bool* huge_pages = nullptr, bool reserve_only = false,
+                          int numa_node = -1);
 void deallocate_huge_pages(void* ptr, size_t size);
 
+// Fault in [ptr, ptr + size) of a mapping. Returns false if the memory
+// cannot be committed (explicit huge page pool exhausted).
+bool commit_pages(void* ptr, size_t size) noexcept;
+
+// Bump allocator over a single huge-page mapping, optionally bound to a
+// NUMA node. The address space is reserved up front without committing
+// it; each allocation is committed and pre-faulted when carved, so only
+// carved memory is backed and the hot path never takes a page fault.
+// Not thread-safe - carve memory during setup or from the owning thread.
+class HugePageArena {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    
+    explicit HugePageArena(size_t bytes, int numa_node = -1);
+    ~HugePageArena();
+    
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+    
+    // Returns nullptr once the arena is exhausted, or if the carved range
+    // cannot be committed
+    void* allocate(size_t size, size_t alignment = 64) noexcept;
+    
+    size_t capacity() const noexcept { return capacity_; }
+    size_t used() const noexcept { return used_; }
+    size_t committed() const noexcept { return committed_; }
+    bool huge_pages() const noexcept { return huge_pages_; }  // False: regular pages + THP hint
+    
+private:
+    uint8_t* base_;
+    size_t capacity_;
+    size_t used_;
+    size_t committed_;   // Backed prefix, in whole huge pages
+    int numa_node_;
+    bool huge_pages_;
+};
+
 // Lock-free ring buffer logger
 template<size_t Capacity>
 class RingLogger {
@@ -0,0 +1,137 @@
+#include "execution_bus.hpp"
+#include <iostream>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob {
+
+namespace detail {
+
+BusRegion::~BusRegion() {
+    if (base) munmap(base, bytes);
+    if (fd >= 0) close(fd);
+}
+
+namespace {
+
+size_t region_bytes(uint64_t capacity) {
+    return sizeof(BusHeader) + capacity * sizeof(BusSlot);
+}
+
+// Map the region and point header/slots into it
+bool map_region(BusRegion& region, size_t bytes, bool writable) {
+    const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* base = mmap(nullptr, bytes, prot, MAP_SHARED, region.fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    region.base = base;
+    region.bytes = bytes;
+    region.header = static_cast<BusHeader*>(base);
+    region.slots = reinterpret_cast<BusSlot*>(static_cast<char*>(base) + sizeof(BusHeader));
+    return true;
+}
+
+} // namespace
+
+} // namespace detail
+
+std::unique_ptr<ExecutionBusWriter> ExecutionBusWriter::create(const char* name,
+                                                               size_t capacity) {
+    uint64_t slots = 2;
+    while (slots < capacity) slots <<= 1;
+    const size_t bytes = detail::region_bytes(slots);
+
+    std::unique_ptr<ExecutionBusWriter> writer(new ExecutionBusWriter());
+    detail::BusRegion& region = writer->region_;
+
+    if (name) {
+        if (std::strlen(name) >= sizeof(writer->name_)) {
+            std::cerr << "ERROR: Execution bus name too long: " << name << std::endl;
+            return nullptr;
+        }
+        region.fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (region.fd >= 0) std::strcpy(writer->name_, name);
+    } else {
+        region.fd = memfd_create("lob_execution_bus", MFD_CLOEXEC);
+    }
+    if (region.fd < 0) {
+        std::perror("ERROR: Execution bus shared memory");
+        return nullptr;
+    }
+
+    if (ftruncate(region.fd, static_cast<off_t>(bytes)) != 0 ||
+        !detail::map_region(region, bytes, true)) {
+        std::perror("ERROR: Execution bus mapping");
+        return nullptr;
+    }
+    region.mask = slots - 1;
+
+    // Fresh pages are zero: every slot sequence is 0 and head is 0. The
+    // header is filled in last so readers never see a half-built bus.
+    region.header->capacity = slots;
+    region.header->slot_size = sizeof(detail::BusSlot);
+    region.header->version = detail::BUS_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    region.header->magic = detail::BUS_MAGIC;
+
+    return writer;
+}
+
+ExecutionBusWriter::~ExecutionBusWriter() {
+    // Readers keep their mappings; the name just goes away
+    if (name_[0]) shm_unlink(name_);
+}
+
+std::unique_ptr<ExecutionBusReader> ExecutionBusReader::open(const char* name,
+                                                             bool from_oldest) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        std::perror("ERROR: Execution bus open");
+        return nullptr;
+    }
+    return attach(fd, from_oldest);
+}
+
+std::unique_ptr<ExecutionBusReader> ExecutionBusReader::open(int fd, bool from_oldest) {
+    // Own a duplicate so the caller's descriptor stays theirs
+    const int own_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own_fd < 0) {
+        std::perror("ERROR: Execution bus open");
+        return nullptr;
+    }
+    return attach(own_fd, from_oldest);
+}
+
+std::unique_ptr<ExecutionBusReader> ExecutionBusReader::attach(int fd, bool from_oldest) {
+    std::unique_ptr<ExecutionBusReader> reader(new ExecutionBusReader());
+    detail::BusRegion& region = reader->region_;
+    region.fd = fd;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(detail::BusHeader) ||
+        !detail::map_region(region, static_cast<size_t>(info.st_size), false)) {
+        std::cerr << "ERROR: Execution bus is not mapped" << std::endl;
+        return nullptr;
+    }
+
+    const detail::BusHeader& header = *region.header;
+    if (header.magic != detail::BUS_MAGIC || header.version != detail::BUS_VERSION ||
+        header.slot_size != sizeof(detail::BusSlot) ||
+        detail::region_bytes(header.capacity) > region.bytes) {
+        std::cerr << "ERROR: Execution bus layout mismatch" << std::endl;
+        return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    region.mask = header.capacity - 1;
+
+    reader->cursor_ = from_oldest ? reader->oldest_held()
+                                  : header.head.load(std::memory_order_acquire);
+    return reader;
+}
+
+} // namespace lob
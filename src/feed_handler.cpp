@@ -1,11 +1,28 @@
 #include "feed_handler.hpp"
+#include "spsc_queue.hpp"
 #include "utils.hpp"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace lob {
 
+namespace {
+
+// Waits on the other side of the pipeline yield after about 64 pauses, in
+// case the other side is sharing the core
+constexpr unsigned PIPELINE_BACKOFF_SHIFT = 5;
+
+} // namespace
+
 FeedHandler::FeedHandler(MatchingEngine& engine)
     : engine_(engine), running_(false), messages_processed_(0), last_timestamp_(0) {
 }
@@ -14,15 +31,55 @@ FeedHandler::~FeedHandler() {
     stop_live_feed();
 }
 
-void FeedHandler::replay_itch_file(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cerr << "Failed to open ITCH file: " << filename << std::endl;
-        return;
+void FeedHandler::replay_itch_file(const std::string& filename, ReplayMode mode) {
+    static const char* const MODE_NAMES[] = {" (stream)", " (mmap)", " (pipelined)"};
+    std::cout << "Replaying ITCH file: " << filename
+              << MODE_NAMES[static_cast<uint8_t>(mode)] << std::endl;
+    
+    uint64_t start_time = get_timestamp_ns();
+    messages_processed_.store(0);
+    
+    if (mode == ReplayMode::STREAM) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to open ITCH file: " << filename << std::endl;
+            return;
+        }
+        replay_stream(file);
+    } else {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            std::cerr << "Failed to open ITCH file: " << filename << std::endl;
+            if (fd >= 0) close(fd);
+            return;
+        }
+        
+        const size_t size = static_cast<size_t>(info.st_size);
+        void* mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);  // The mapping keeps the file open
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map ITCH file: " << filename << std::endl;
+            return;
+        }
+        if (mapping) {
+            replay_mapped(static_cast<const uint8_t*>(mapping), size,
+                          mode == ReplayMode::PIPELINED);
+            munmap(mapping, size);
+        }
     }
     
-    std::cout << "Replaying ITCH file: " << filename << std::endl;
+    uint64_t message_count = messages_processed_.load();
+    uint64_t elapsed = get_timestamp_ns() - start_time;
+    double msg_per_sec = (message_count * 1e9) / elapsed;
     
+    std::cout << "\nReplay complete:" << std::endl;
+    std::cout << "  Total messages: " << message_count << std::endl;
+    std::cout << "  Elapsed time: " << format_duration(elapsed) << std::endl;
+    std::cout << "  Throughput: " << (msg_per_sec / 1e6) << " million msg/s" << std::endl;
+}
+
+void FeedHandler::replay_stream(std::ifstream& file) {
     uint64_t start_time = get_timestamp_ns();
     uint64_t message_count = 0;
     
@@ -33,6 +90,7 @@ void FeedHandler::replay_itch_file(const std::string& filename) {
         if (!file) break;
         
         msg_length = ntohs(msg_length);
+        if (msg_length == 0) break;
         
         // Read message type (1 byte)
         uint8_t msg_type;
@@ -50,99 +108,314 @@ void FeedHandler::replay_itch_file(const std::string& filename) {
         ++message_count;
         
         if (message_count % 1000000 == 0) {
-            uint64_t elapsed = get_timestamp_ns() - start_time;
-            double msg_per_sec = (message_count * 1e9) / elapsed;
-            std::cout << "Processed " << message_count 
-                     << " messages (" << (msg_per_sec / 1e6) << "M msg/s)" << std::endl;
+            report_progress(message_count, start_time);
         }
     }
     
-    uint64_t elapsed = get_timestamp_ns() - start_time;
-    double msg_per_sec = (message_count * 1e9) / elapsed;
-    
-    std::cout << "\nReplay complete:" << std::endl;
-    std::cout << "  Total messages: " << message_count << std::endl;
-    std::cout << "  Elapsed time: " << format_duration(elapsed) << std::endl;
-    std::cout << "  Throughput: " << (msg_per_sec / 1e6) << " million msg/s" << std::endl;
-    
     messages_processed_.store(message_count);
 }
 
-void FeedHandler::process_message(uint8_t msg_type, const uint8_t* data, size_t length) {
-    switch (static_cast<ITCHMessageType>(msg_type)) {
-        case ITCHMessageType::ADD_ORDER: {
-            if (length >= sizeof(ITCHAddOrder)) {
-                const auto* msg = reinterpret_cast<const ITCHAddOrder*>(data);
-                handle_add_order(*msg);
+void FeedHandler::replay_mapped(const uint8_t* data, size_t size, bool pipelined) {
+    madvise(const_cast<uint8_t*>(data), size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(const_cast<uint8_t*>(data), size, MADV_HUGEPAGE);  // Honoured by some filesystems
+#endif
+    
+    // Keep the kernel READ_AHEAD_BYTES ahead of the parser, so page faults
+    // on the replay thread find the page cache already filled
+    std::atomic<size_t> parsed{0};
+    std::atomic<bool> done{false};
+    std::thread read_ahead([data, size, &parsed, &done] {
+        size_t requested = 0;
+        while (requested < size && !done.load(std::memory_order_relaxed)) {
+            if (requested < parsed.load(std::memory_order_relaxed) + READ_AHEAD_BYTES) {
+                const size_t chunk = std::min(READ_AHEAD_CHUNK, size - requested);
+                madvise(const_cast<uint8_t*>(data) + requested, chunk, MADV_WILLNEED);
+                requested += chunk;
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
             }
-            break;
         }
-        
-        case ITCHMessageType::ORDER_CANCEL: {
-            if (length >= sizeof(ITCHOrderCancel)) {
-                const auto* msg = reinterpret_cast<const ITCHOrderCancel*>(data);
-                handle_order_cancel(*msg);
-            }
-            break;
+    });
+    
+    uint64_t start_time = get_timestamp_ns();
+    uint64_t reported = 0;
+    auto report = [this, start_time, &reported] {
+        const uint64_t message_count = messages_processed_.load(std::memory_order_relaxed);
+        if (message_count / 1000000 != reported) {
+            reported = message_count / 1000000;
+            report_progress(message_count, start_time);
         }
+    };
+    
+    // Parse a chunk at a time, publishing progress to the read-ahead
+    // thread. Decoded commands go to apply_command.
+    auto parse = [this, data, size, &parsed](auto&& apply_command, auto&& after_chunk) {
+        size_t offset = 0;
+        while (offset < size) {
+            const size_t window = std::min(READ_AHEAD_CHUNK, size - offset);
+            const size_t consumed = decode_buffer(data + offset, window, apply_command);
+            if (consumed == 0) break;  // Truncated trailing message
+            offset += consumed;
+            parsed.store(offset, std::memory_order_relaxed);
+            after_chunk();
+        }
+    };
+    
+    if (!pipelined) {
+        parse([this](const EngineCommand& command) { engine_.apply(command); }, report);
+    } else {
+        // Decoder thread: ITCH bytes to EngineCommands, DECODE_BATCH at a
+        // time into the ring. This thread only drains the ring into
+        // submit_batch, so the engine's caches hold book state, not feed.
+        SPSCQueue<EngineCommand> ring(PIPELINE_RING_SIZE);
+        std::atomic<bool> decoded{false};
+        std::thread decoder([this, &ring, &decoded, &parse] {
+            if (decoder_cpu_ >= 0) set_cpu_affinity(decoder_cpu_);
+            
+            EngineCommand batch[DECODE_BATCH];
+            size_t count = 0;
+            auto flush = [&ring, &batch, &count] {
+                size_t pushed = 0;
+                unsigned rounds = 0;
+                while (pushed < count) {
+                    const size_t n = ring.push_n(batch + pushed, count - pushed);
+                    if (n == 0) backoff(rounds, PIPELINE_BACKOFF_SHIFT);  // Engine is behind
+                    pushed += n;
+                }
+                count = 0;
+            };
+            parse([&batch, &count, &flush](const EngineCommand& command) {
+                      batch[count] = command;
+                      if (++count == DECODE_BATCH) flush();
+                  },
+                  flush);
+            flush();
+            decoded.store(true, std::memory_order_release);
+        });
         
-        case ITCHMessageType::ORDER_DELETE: {
-            if (length >= sizeof(ITCHOrderDelete)) {
-                const auto* msg = reinterpret_cast<const ITCHOrderDelete*>(data);
-                handle_order_delete(*msg);
+        EngineCommand batch[DECODE_BATCH];
+        unsigned rounds = 0;
+        for (;;) {
+            // Read the flag first: once set, everything it covers is in the ring
+            const bool finished = decoded.load(std::memory_order_acquire);
+            const size_t count = ring.pop_n(batch, DECODE_BATCH);
+            if (count) {
+                engine_.submit_batch(batch, count);
+                report();
+                rounds = 0;
+            } else if (finished) {
+                break;
+            } else {
+                backoff(rounds, PIPELINE_BACKOFF_SHIFT);
             }
-            break;
         }
+        decoder.join();
+    }
+    
+    done.store(true, std::memory_order_relaxed);
+    read_ahead.join();
+}
+
+size_t FeedHandler::replay_itch_buffer(const uint8_t* data, size_t size) {
+    return decode_buffer(data, size,
+                         [this](const EngineCommand& command) { engine_.apply(command); });
+}
+
+size_t FeedHandler::replay_itch_messages(const uint8_t* data, size_t size,
+                                         const uint64_t* offsets, size_t count) {
+    // A partition's messages are scattered through the file, so fetch
+    // ahead of the decoder
+    constexpr size_t PREFETCH_AHEAD = 8;
+    size_t processed = 0;
+    for (; processed < count; ++processed) {
+        if (processed + PREFETCH_AHEAD < count && offsets[processed + PREFETCH_AHEAD] < size) {
+            __builtin_prefetch(data + offsets[processed + PREFETCH_AHEAD], 0, 0);
+        }
+        
+        // Offsets may come from an index file; never trust them past size
+        const uint64_t offset = offsets[processed];
+        if (offset >= size || size - offset <= sizeof(uint16_t)) break;
+        const size_t msg_length = parse_uint16(data + offset);
+        if (msg_length == 0 || msg_length > size - offset - sizeof(uint16_t)) break;
         
-        default:
-            // Ignore other message types for now
-            break;
+        const uint8_t* msg = data + offset + sizeof(uint16_t);
+        process_message(msg[0], msg + 1, msg_length - 1);
     }
+    messages_processed_.fetch_add(processed, std::memory_order_relaxed);
+    return processed;
 }
 
-void FeedHandler::handle_add_order(const ITCHAddOrder& msg) {
-    std::string symbol = parse_stock_symbol(msg.stock);
+template<typename Sink>
+size_t FeedHandler::decode_buffer(const uint8_t* data, size_t size, Sink&& sink) {
+    uint64_t message_count = 0;
+    size_t offset = 0;
     
-    Side side = (msg.buy_sell_indicator == 'B') ? Side::BUY : Side::SELL;
-    uint64_t timestamp = __builtin_bswap64(msg.timestamp);
-    uint64_t order_id = __builtin_bswap64(msg.order_ref_num);
-    uint32_t price = __builtin_bswap32(msg.price);
-    uint32_t quantity = __builtin_bswap32(msg.shares);
+    while (offset + sizeof(uint16_t) < size) {
+        const size_t msg_length = parse_uint16(data + offset);
+        if (msg_length == 0 || offset + sizeof(uint16_t) + msg_length > size) break;
+        
+        const uint8_t* msg = data + offset + sizeof(uint16_t);
+        EngineCommand command;
+        if (decode_message(msg[0], msg + 1, msg_length - 1, command)) {
+            sink(command);
+        }
+        offset += sizeof(uint16_t) + msg_length;
+        ++message_count;
+    }
     
-    engine_.submit_order(symbol.c_str(), order_id, timestamp, 
-                        price, quantity, side, OrderType::LIMIT);
+    messages_processed_.fetch_add(message_count, std::memory_order_relaxed);
+    return offset;
 }
 
-void FeedHandler::handle_order_cancel(const ITCHOrderCancel& msg) {
-    uint64_t order_id = __builtin_bswap64(msg.order_ref_num);
+void FeedHandler::report_progress(uint64_t message_count, uint64_t start_time) const {
+    uint64_t elapsed = get_timestamp_ns() - start_time;
+    double msg_per_sec = (message_count * 1e9) / elapsed;
+    std::cout << "Processed " << message_count
+              << " messages (" << (msg_per_sec / 1e6) << "M msg/s)" << std::endl;
+}
+
+const std::array<FeedHandler::MessageDecoder, 256> FeedHandler::MESSAGE_DECODERS =
+    FeedHandler::make_message_decoders();
+
+std::array<FeedHandler::MessageDecoder, 256> FeedHandler::make_message_decoders() {
+    std::array<MessageDecoder, 256> decoders;
+    decoders.fill(MessageDecoder{0, &FeedHandler::ignore_message});
     
-    // Note: We'd need to track order_id to symbol mapping in production
-    // For now, this is a simplified implementation
-    (void)order_id;
+    auto set = [&decoders](ITCHMessageType type, size_t length,
+                           bool (FeedHandler::*decode)(const uint8_t*, EngineCommand&)) {
+        decoders[static_cast<uint8_t>(type)] = MessageDecoder{length, decode};
+    };
+    set(ITCHMessageType::STOCK_DIRECTORY, sizeof(ITCHStockDirectory),
+        &FeedHandler::dispatch<ITCHStockDirectory, &FeedHandler::decode_stock_directory>);
+    set(ITCHMessageType::ADD_ORDER, sizeof(ITCHAddOrder),
+        &FeedHandler::dispatch<ITCHAddOrder, &FeedHandler::decode_add_order>);
+    // 'F' is 'A' plus an attribution; the attribution is not tracked
+    set(ITCHMessageType::ADD_ORDER_MPID, sizeof(ITCHAddOrderMPID),
+        &FeedHandler::dispatch<ITCHAddOrder, &FeedHandler::decode_add_order>);
+    set(ITCHMessageType::ORDER_EXECUTED, sizeof(ITCHOrderExecuted),
+        &FeedHandler::dispatch<ITCHOrderExecuted, &FeedHandler::decode_order_executed>);
+    set(ITCHMessageType::ORDER_EXECUTED_WITH_PRICE, sizeof(ITCHOrderExecutedWithPrice),
+        &FeedHandler::dispatch<ITCHOrderExecutedWithPrice,
+                               &FeedHandler::decode_order_executed_with_price>);
+    set(ITCHMessageType::ORDER_CANCEL, sizeof(ITCHOrderCancel),
+        &FeedHandler::dispatch<ITCHOrderCancel, &FeedHandler::decode_order_cancel>);
+    set(ITCHMessageType::ORDER_DELETE, sizeof(ITCHOrderDelete),
+        &FeedHandler::dispatch<ITCHOrderDelete, &FeedHandler::decode_order_delete>);
+    set(ITCHMessageType::ORDER_REPLACE, sizeof(ITCHOrderReplace),
+        &FeedHandler::dispatch<ITCHOrderReplace, &FeedHandler::decode_order_replace>);
+    set(ITCHMessageType::TRADE, sizeof(ITCHTrade),
+        &FeedHandler::dispatch<ITCHTrade, &FeedHandler::decode_trade>);
+    set(ITCHMessageType::CROSS_TRADE, sizeof(ITCHCrossTrade),
+        &FeedHandler::dispatch<ITCHCrossTrade, &FeedHandler::decode_cross_trade>);
+    set(ITCHMessageType::BROKEN_TRADE, sizeof(ITCHBrokenTrade),
+        &FeedHandler::dispatch<ITCHBrokenTrade, &FeedHandler::decode_broken_trade>);
+    return decoders;
 }
 
-void FeedHandler::handle_order_delete(const ITCHOrderDelete& msg) {
-    uint64_t order_id = __builtin_bswap64(msg.order_ref_num);
-    (void)order_id;
+void FeedHandler::process_message(uint8_t msg_type, const uint8_t* data, size_t length) {
+    EngineCommand command;
+    if (decode_message(msg_type, data, length, command)) {
+        engine_.apply(command);
+    }
 }
 
-uint16_t FeedHandler::parse_uint16(const uint8_t* data) {
-    return ntohs(*reinterpret_cast<const uint16_t*>(data));
+bool FeedHandler::decode_stock_directory(const ITCHStockDirectory& msg, EngineCommand& command) {
+    command.type = CommandType::DIRECTORY;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = pack_itch_symbol(msg.stock);
+    return true;
+}
+
+bool FeedHandler::decode_add_order(const ITCHAddOrder& msg, EngineCommand& command) {
+    command.type = CommandType::ADD;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.side = (msg.buy_sell_indicator == 'B') ? Side::BUY : Side::SELL;
+    command.order_type = OrderType::LIMIT;
+    command.timestamp = parse_timestamp(msg.timestamp);
+    command.order_id = __builtin_bswap64(msg.order_ref_num);
+    command.price = __builtin_bswap32(msg.price);
+    command.quantity = __builtin_bswap32(msg.shares);
+    return true;
+}
+
+bool FeedHandler::decode_order_executed(const ITCHOrderExecuted& msg, EngineCommand& command) {
+    command.type = CommandType::EXECUTE;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = __builtin_bswap64(msg.order_ref_num);
+    command.quantity = __builtin_bswap32(msg.executed_shares);
+    command.timestamp = parse_timestamp(msg.timestamp);
+    command.price = 0;  // At the resting order's price
+    return true;
+}
+
+bool FeedHandler::decode_order_executed_with_price(const ITCHOrderExecutedWithPrice& msg,
+                                                   EngineCommand& command) {
+    // Non-printable executions still take the shares off the book
+    command.type = CommandType::EXECUTE;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = __builtin_bswap64(msg.order_ref_num);
+    command.quantity = __builtin_bswap32(msg.executed_shares);
+    command.timestamp = parse_timestamp(msg.timestamp);
+    command.price = __builtin_bswap32(msg.execution_price);
+    return true;
+}
+
+bool FeedHandler::decode_order_cancel(const ITCHOrderCancel& msg, EngineCommand& command) {
+    command.type = CommandType::REDUCE;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = __builtin_bswap64(msg.order_ref_num);
+    command.quantity = __builtin_bswap32(msg.cancelled_shares);
+    return true;
 }
 
-uint32_t FeedHandler::parse_uint32(const uint8_t* data) {
-    return ntohl(*reinterpret_cast<const uint32_t*>(data));
+bool FeedHandler::decode_order_delete(const ITCHOrderDelete& msg, EngineCommand& command) {
+    command.type = CommandType::CANCEL;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = __builtin_bswap64(msg.order_ref_num);
+    return true;
 }
 
-uint64_t FeedHandler::parse_uint64(const uint8_t* data) {
-    return __builtin_bswap64(*reinterpret_cast<const uint64_t*>(data));
+bool FeedHandler::decode_order_replace(const ITCHOrderReplace& msg, EngineCommand& command) {
+    command.type = CommandType::REPLACE;
+    command.stock_locate = __builtin_bswap16(msg.stock_locate);
+    command.order_id = __builtin_bswap64(msg.original_order_ref_num);
+    command.new_order_id = __builtin_bswap64(msg.new_order_ref_num);
+    command.timestamp = parse_timestamp(msg.timestamp);
+    command.price = __builtin_bswap32(msg.price);
+    command.quantity = __builtin_bswap32(msg.shares);
+    return true;
+}
+
+bool FeedHandler::decode_trade(const ITCHTrade& msg, EngineCommand&) {
+    // Hidden liquidity - nothing rests in the displayed book
+    ++trade_stats_.trades;
+    trade_stats_.trade_volume += __builtin_bswap32(msg.shares);
+    return false;
+}
+
+bool FeedHandler::decode_cross_trade(const ITCHCrossTrade& msg, EngineCommand&) {
+    ++trade_stats_.cross_trades;
+    trade_stats_.cross_volume += __builtin_bswap64(msg.shares);
+    return false;
+}
+
+bool FeedHandler::decode_broken_trade(const ITCHBrokenTrade&, EngineCommand&) {
+    // Busts a past print; the book itself is unaffected
+    ++trade_stats_.broken_trades;
+    return false;
+}
+
+uint16_t FeedHandler::parse_uint16(const uint8_t* data) {
+    uint16_t value;
+    std::memcpy(&value, data, sizeof(value));  // Length prefixes are unaligned
+    return ntohs(value);
 }
 
-std::string FeedHandler::parse_stock_symbol(const char* data) {
-    std::string symbol(data, 8);
-    // Trim trailing spaces
-    size_t end = symbol.find_last_not_of(' ');
-    return (end != std::string::npos) ? symbol.substr(0, end + 1) : symbol;
+uint64_t FeedHandler::parse_timestamp(const uint8_t* data) {
+    uint64_t value = 0;
+    std::memcpy(reinterpret_cast<uint8_t*>(&value) + 2, data, 6);
+    return __builtin_bswap64(value);
 }
 
 void FeedHandler::start_live_feed(const std::string& interface, uint16_t port) {
@@ -0,0 +1,30 @@
+#include "level_pool.hpp"
+#include "utils.hpp"
+#include <new>
+
+namespace lob {
+
+PriceLevelPool::PriceLevelPool(size_t chunk_levels, HugePageArena* arena)
+    : chunk_levels_(chunk_levels ? chunk_levels : 1), arena_(arena) {}
+
+PriceLevelPool::~PriceLevelPool() {
+    // PriceLevel is trivially destructible
+    for (PriceLevel* chunk : heap_chunks_) {
+        ::operator delete(chunk, std::align_val_t(alignof(PriceLevel)));
+    }
+}
+
+void PriceLevelPool::grow() {
+    const size_t bytes = chunk_levels_ * sizeof(PriceLevel);
+    void* mem = arena_ ? arena_->allocate(bytes, alignof(PriceLevel)) : nullptr;
+    if (!mem) {
+        mem = ::operator new(bytes, std::align_val_t(alignof(PriceLevel)));
+        heap_chunks_.push_back(static_cast<PriceLevel*>(mem));
+    }
+    
+    chunk_next_ = static_cast<PriceLevel*>(mem);
+    chunk_end_ = chunk_next_ + chunk_levels_;
+    ++chunk_count_;
+}
+
+} // namespace lob
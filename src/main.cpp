@@ -120,6 +120,7 @@ int main(int argc, char** argv) {
         
         EngineConfig config;
         config.cpu_affinity = 0;
+        config.mirror_mode = true;  // Rebuild the venue's books, no matching
         
         auto engine = std::make_unique<MatchingEngine>(config);
         engine->start();
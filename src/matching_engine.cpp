@@ -2,15 +2,52 @@
 #include "utils.hpp"
 #include <iostream>
 #include <cstring>
+#include <climits>
 
 #ifdef __linux__
 #include <numa.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 namespace lob {
 
+namespace {
+
+constexpr unsigned MAX_BACKOFF_SHIFT = 10;  // 1024 pauses
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+            expected, nullptr, nullptr, 0);
+#else
+    (void)word;
+    (void)expected;
+    std::this_thread::yield();
+#endif
+}
+
+void futex_wake(std::atomic<uint32_t>& word) noexcept {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+            INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+} // namespace
+
 MatchingEngine::MatchingEngine(const EngineConfig& config)
-    : config_(config), pool_index_(0), 
+    : config_(config), arena_(make_arena(config)),
+      level_pool_(config.book_config.level_chunk_size, arena_.get()),
+      order_directory_(config.order_directory,
+                       config.order_directory == OrderDirectoryType::DIRECT
+                           ? config.direct_window : config.order_pool_size),
+      locate_books_(MAX_STOCK_LOCATE + 1, nullptr),
+      order_pool_(config.order_pool_size, arena_.get()),
+      execution_queue_(config.execution_queue_size),
       total_orders_(0), total_matches_(0), running_(false) {
     
     // Setup NUMA and CPU affinity
@@ -18,28 +55,14 @@ MatchingEngine::MatchingEngine(const EngineConfig& config)
         setup_numa_affinity();
     }
     
-    if (config_.cpu_affinity >= 0) {
+    // With an event loop the loop thread takes the core instead
+    if (config_.cpu_affinity >= 0 && !config_.run_event_loop) {
         setup_cpu_affinity();
     }
     
-    // Pre-allocate order pool
-    order_pool_.reserve(config_.order_pool_size);
-    
-#ifdef __linux__
-    if (config_.numa_node >= 0) {
-        // NUMA-aware allocation
-        for (size_t i = 0; i < config_.order_pool_size; ++i) {
-            void* mem = numa_alloc_onnode(sizeof(Order), config_.numa_node);
-            order_pool_.push_back(new (mem) Order());
-        }
-    } else {
-#endif
-        for (size_t i = 0; i < config_.order_pool_size; ++i) {
-            order_pool_.push_back(new Order());
-        }
-#ifdef __linux__
+    if (config_.run_event_loop) {
+        ingress_ = std::make_unique<IngressQueue>();
     }
-#endif
     
     std::cout << "Matching engine initialized with " << config_.order_pool_size 
               << " order pool size" << std::endl;
@@ -47,22 +70,7 @@ MatchingEngine::MatchingEngine(const EngineConfig& config)
 
 MatchingEngine::~MatchingEngine() {
     stop();
-    
-    // Cleanup order pool
-#ifdef __linux__
-    if (config_.numa_node >= 0) {
-        for (Order* order : order_pool_) {
-            order->~Order();
-            numa_free(order, sizeof(Order));
-        }
-    } else {
-#endif
-        for (Order* order : order_pool_) {
-            delete order;
-        }
-#ifdef __linux__
-    }
-#endif
+    stop_execution_drain();
 }
 
 
@@ -72,19 +80,54 @@ void MatchingEngine::submit_order(const char* symbol, uint64_t order_id,
     // Get or create order book
     OrderBook* book = get_book(symbol);
     if (!book) {
-        books_[symbol] = std::make_unique<OrderBook>();
-        book = books_[symbol].get();
+        book = add_book(symbol, config_.book_config);
+        if (!book) {
+            ++rejected_orders_;  // Empty symbol
+            return;
+        }
+    }
+    
+    submit_to_book(book, order_id, timestamp, price, quantity, side, type);
+}
+
+void MatchingEngine::submit_order(SymbolId symbol, uint64_t order_id,
+                                  uint64_t timestamp, uint32_t price,
+                                  uint32_t quantity, Side side, OrderType type) {
+    OrderBook* book = get_book(symbol);
+    if (!book) {
+        if (!symbol.valid()) return;
+        book = symbol_slot(symbol) = create_book(config_.book_config);
+    }
+    
+    submit_to_book(book, order_id, timestamp, price, quantity, side, type);
+}
+
+void MatchingEngine::submit_order(uint16_t stock_locate, uint64_t order_id,
+                                  uint64_t timestamp, uint32_t price,
+                                  uint32_t quantity, Side side, OrderType type) {
+    OrderBook* book = locate_books_[stock_locate];
+    if (!book) {
+        // No Stock Directory message seen for this locate
+        book = add_book(stock_locate, nullptr, config_.book_config);
+    }
+    
+    submit_to_book(book, order_id, timestamp, price, quantity, side, type);
+}
+
+void MatchingEngine::submit_to_book(OrderBook* book, uint64_t order_id,
+                                    uint64_t timestamp, uint32_t price,
+                                    uint32_t quantity, Side side, OrderType type) {
+    // Ids are engine-wide; a second live order under one id would shadow
+    // the first in the directory
+    if (order_directory_.find(order_id)) {
+        ++rejected_orders_;
+        return;
     }
     
     // Allocate order from pool
     Order* order = allocate_order();
     if (!order) {
-        // Don't spam stderr on every failure
-        static std::atomic<size_t> error_count{0};
-        if (error_count.fetch_add(1) % 100000 == 0) {
-            std::cerr << "ERROR: Order pool exhausted at order " << order_id 
-                      << " (suppressing further messages)" << std::endl;
-        }
+        ++rejected_orders_;
         return;
     }
     
@@ -96,27 +139,27 @@ void MatchingEngine::submit_order(const char* symbol, uint64_t order_id,
     order->side = side;
     order->type = type;
     
-    // Match aggressive orders
-    if (type == OrderType::MARKET || 
-        (type == OrderType::LIMIT && 
-         ((side == Side::BUY && book->get_best_ask() && price >= book->get_best_ask()->price) ||
-          (side == Side::SELL && book->get_best_bid() && price <= book->get_best_bid()->price)))) {
-        
-        auto reports = book->match_order(order);
+    // Match aggressive orders; mirrored adds skip straight to the book
+    if (!config_.mirror_mode &&
+        (type == OrderType::MARKET || 
+         (type == OrderType::LIMIT && 
+          ((side == Side::BUY && book->get_best_ask() && price >= book->get_best_ask()->price) ||
+           (side == Side::SELL && book->get_best_bid() && price <= book->get_best_bid()->price))))) {
         
-        // Push execution reports to queue
-        for (const auto& report : reports) {
-            if (!execution_queue_.push(report)) {
-                std::cerr << "WARNING: Execution queue full!" << std::endl;
-                break;
-            }
-            ++total_matches_;
-        }
+        // Fills go straight into the execution queue
+        book->match_order(order, [this](const ExecutionReport& report) {
+            push_report(report);
+        });
     }
     
     // Add remaining quantity to book
     if (order->remaining_quantity > 0 && type == OrderType::LIMIT) {
-        book->add_order(order);
+        if (!book->add_order(order)) {
+            deallocate_order(order);
+            ++rejected_orders_;
+            return;
+        }
+        order_directory_.insert(order_id, order);
     } else {
         deallocate_order(order);
     }
@@ -127,47 +170,445 @@ void MatchingEngine::submit_order(const char* symbol, uint64_t order_id,
 
 void MatchingEngine::cancel_order(const char* symbol, uint64_t order_id) {
     OrderBook* book = get_book(symbol);
-    if (book) {
-        book->cancel_order(order_id);
+    if (Order* order = find_order(book, order_id)) {
+        book->cancel_order(order);
     }
 }
 
 void MatchingEngine::modify_order(const char* symbol, uint64_t order_id, 
                                   uint32_t new_quantity) {
     OrderBook* book = get_book(symbol);
-    if (book) {
-        book->modify_order(order_id, new_quantity);
+    if (Order* order = find_order(book, order_id)) {
+        book->modify_order(order, new_quantity);
     }
 }
 
-OrderBook* MatchingEngine::get_book(const char* symbol) {
-    auto it = books_.find(symbol);
-    return (it != books_.end()) ? it->second.get() : nullptr;
+void MatchingEngine::cancel_order(SymbolId symbol, uint64_t order_id) {
+    OrderBook* book = get_book(symbol);
+    if (Order* order = find_order(book, order_id)) {
+        book->cancel_order(order);
+    }
+}
+
+void MatchingEngine::modify_order(SymbolId symbol, uint64_t order_id,
+                                  uint32_t new_quantity) {
+    OrderBook* book = get_book(symbol);
+    if (Order* order = find_order(book, order_id)) {
+        book->modify_order(order, new_quantity);
+    }
+}
+
+void MatchingEngine::cancel_order(uint16_t stock_locate, uint64_t order_id) {
+    OrderBook* book = locate_books_[stock_locate];
+    if (Order* order = find_order(book, order_id)) {
+        book->cancel_order(order);
+    }
+}
+
+void MatchingEngine::modify_order(uint16_t stock_locate, uint64_t order_id,
+                                  uint32_t new_quantity) {
+    OrderBook* book = locate_books_[stock_locate];
+    if (Order* order = find_order(book, order_id)) {
+        book->modify_order(order, new_quantity);
+    }
+}
+
+void MatchingEngine::apply(const EngineCommand& command) {
+    switch (command.type) {
+        case CommandType::ADD:
+            submit_order(command.stock_locate, command.order_id, command.timestamp,
+                         command.price, command.quantity, command.side, command.order_type);
+            break;
+        case CommandType::CANCEL:
+            delete_order(command.order_id);
+            break;
+        case CommandType::REDUCE:
+            reduce_order(command.order_id, command.quantity);
+            break;
+        case CommandType::MODIFY:
+            if (Order* order = order_directory_.find(command.order_id)) {
+                order->book->modify_order(order, command.quantity);
+            }
+            break;
+        case CommandType::REPLACE:
+            replace_order(command.order_id, command.new_order_id, command.timestamp,
+                          command.price, command.quantity);
+            break;
+        case CommandType::DIRECTORY: {
+            char symbol[sizeof(SymbolKey) + 1] = {};
+            std::memcpy(symbol, &command.order_id, sizeof(SymbolKey));
+            add_book(command.stock_locate, symbol, config_.book_config);
+            break;
+        }
+        case CommandType::EXECUTE:
+            if (command.price) {
+                execute_order(command.order_id, command.quantity, command.timestamp, command.price);
+            } else {
+                execute_order(command.order_id, command.quantity, command.timestamp);
+            }
+            break;
+    }
+}
+
+void MatchingEngine::submit_batch(const EngineCommand* commands, size_t count) {
+    if (spill_head_ != spill_.size()) flush_executions();
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (i + PREFETCH_SLOTS_AHEAD < count) {
+            prefetch_slots(commands[i + PREFETCH_SLOTS_AHEAD]);
+        }
+        if (i + PREFETCH_OBJECTS_AHEAD < count) {
+            prefetch_objects(commands[i + PREFETCH_OBJECTS_AHEAD]);
+        }
+        if (i + PREFETCH_LINKS_AHEAD < count) {
+            prefetch_links(commands[i + PREFETCH_LINKS_AHEAD]);
+        }
+        if (i + PREFETCH_LEVELS_AHEAD < count) {
+            prefetch_levels(commands[i + PREFETCH_LEVELS_AHEAD]);
+        }
+        apply(commands[i]);
+    }
+}
+
+void MatchingEngine::prefetch_slots(const EngineCommand& command) const noexcept {
+    __builtin_prefetch(&locate_books_[command.stock_locate], 0, 3);
+    order_directory_.prefetch(command.order_id);
+}
+
+void MatchingEngine::prefetch_objects(const EngineCommand& command) noexcept {
+    if (command.type == CommandType::ADD) {
+        if (OrderBook* book = locate_books_[command.stock_locate]) {
+            book->prefetch_book();
+        }
+    } else if (Order* order = order_directory_.find(command.order_id)) {
+        __builtin_prefetch(order, 1, 3);
+    }
+}
+
+void MatchingEngine::prefetch_links(const EngineCommand& command) noexcept {
+    if (command.type == CommandType::ADD) {
+        if (OrderBook* book = locate_books_[command.stock_locate]) {
+            book->prefetch_level_slot(command.price, command.side);
+        }
+    } else if (Order* order = order_directory_.find(command.order_id)) {
+        // Unlinking touches the level and both queue neighbours
+        if (order->parent_level) __builtin_prefetch(order->parent_level, 1, 3);
+        if (order->prev) __builtin_prefetch(order->prev, 1, 3);
+        if (order->next) __builtin_prefetch(order->next, 1, 3);
+    }
+}
+
+void MatchingEngine::prefetch_levels(const EngineCommand& command) noexcept {
+    if (command.type == CommandType::ADD) {
+        if (OrderBook* book = locate_books_[command.stock_locate]) {
+            book->prefetch_level(command.price, command.side);
+        }
+    }
+}
+
+void MatchingEngine::delete_order(uint64_t order_id) {
+    if (Order* order = order_directory_.find(order_id)) {
+        order->book->cancel_order(order);
+    }
+}
+
+void MatchingEngine::reduce_order(uint64_t order_id, uint32_t cancelled_quantity) {
+    if (Order* order = order_directory_.find(order_id)) {
+        order->book->reduce_order(order, cancelled_quantity);
+    }
+}
+
+void MatchingEngine::execute_order(uint64_t order_id, uint32_t executed_quantity,
+                                   uint64_t timestamp) {
+    if (Order* order = order_directory_.find(order_id)) {
+        push_report(order->book->execute_order(order, executed_quantity,
+                                               order->price, timestamp));
+    }
+}
+
+void MatchingEngine::execute_order(uint64_t order_id, uint32_t executed_quantity,
+                                   uint64_t timestamp, uint32_t price) {
+    if (Order* order = order_directory_.find(order_id)) {
+        push_report(order->book->execute_order(order, executed_quantity, price, timestamp));
+    }
+}
+
+void MatchingEngine::replace_order(uint64_t order_id, uint64_t new_order_id,
+                                   uint64_t timestamp, uint32_t price, uint32_t quantity) {
+    Order* order = order_directory_.find(order_id);
+    if (!order) return;
+    
+    OrderBook* book = order->book;
+    const Side side = order->side;
+    book->cancel_order(order);
+    submit_to_book(book, new_order_id, timestamp, price, quantity, side, OrderType::LIMIT);
+}
+
+OrderBook* MatchingEngine::add_book(const char* symbol, const BookConfig& book_config) {
+    SymbolId id = symbols_.insert(pack_symbol(symbol));
+    if (!id.valid()) {
+        return nullptr;  // Empty symbol
+    }
+    
+    OrderBook*& book = symbol_slot(id);
+    if (!book) {
+        book = create_book(book_config);
+    }
+    return book;
+}
+
+void MatchingEngine::load_symbols(const std::vector<std::string>& symbols) {
+    std::vector<SymbolKey> keys;
+    keys.reserve(symbols.size());
+    for (const std::string& symbol : symbols) {
+        keys.push_back(pack_symbol(symbol.c_str()));
+    }
+    symbols_.load(keys);
+    
+    for (SymbolKey key : keys) {
+        const SymbolId id = symbols_.find(key);
+        if (!id.valid()) continue;  // Empty or too long
+        OrderBook*& book = symbol_slot(id);
+        if (!book) {
+            book = create_book(config_.book_config);
+        }
+    }
+}
+
+OrderBook*& MatchingEngine::symbol_slot(SymbolId symbol) {
+    if (symbol.index >= symbol_books_.size()) {
+        symbol_books_.resize(symbols_.size(), nullptr);
+    }
+    return symbol_books_[symbol.index];
+}
+
+OrderBook* MatchingEngine::add_book(uint16_t stock_locate, const char* symbol,
+                                    const BookConfig& book_config) {
+    OrderBook*& book = locate_books_[stock_locate];
+    if (!book) {
+        book = symbol ? add_book(symbol, book_config) : create_book(book_config);
+    }
+    return book;
+}
+
+OrderBook* MatchingEngine::create_book(const BookConfig& book_config) {
+    BookConfig effective = book_config;
+    effective.release_fn = &MatchingEngine::release_order;
+    effective.release_context = this;
+    effective.level_pool = &level_pool_;
+    effective.index_orders = false;  // order_directory_ covers every book
+    book_storage_.push_back(std::make_unique<OrderBook>(effective));
+    return book_storage_.back().get();
 }
 
 void MatchingEngine::start() {
     running_.store(true, std::memory_order_release);
+    if (ingress_ && !loop_thread_.joinable()) {
+        loop_thread_ = std::thread(&MatchingEngine::run_loop, this);
+    }
 }
 
 void MatchingEngine::stop() {
     running_.store(false, std::memory_order_release);
+    if (loop_thread_.joinable()) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // As in enqueue()
+        wake_loop();
+        loop_thread_.join();
+    }
 }
 
-Order* MatchingEngine::allocate_order() {
-    size_t idx = pool_index_.fetch_add(1, std::memory_order_relaxed);
+bool MatchingEngine::enqueue(const EngineCommand& command) noexcept {
+    if (!ingress_ || !ingress_->push(command)) {
+        return false;
+    }
     
-    // CRITICAL: Check bounds
-    if (idx >= config_.order_pool_size) {
-        std::cerr << "ERROR: Order pool exhausted at index " << idx << std::endl;
-        return nullptr;
+    // Pairs with the fence in idle(): either the loop sees the command
+    // before sleeping, or this sees parked_ set and wakes it
+    if (config_.idle_strategy == IdleStrategy::PARK) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed)) wake_loop();
+    }
+    return true;
+}
+
+void MatchingEngine::wake_loop() noexcept {
+    parked_.store(0, std::memory_order_release);
+    futex_wake(parked_);
+}
+
+void MatchingEngine::run_loop() {
+    if (config_.cpu_affinity >= 0) {
+        setup_cpu_affinity();
     }
     
-    return order_pool_[idx];
+    // Apply commands in batches until stopped, finishing whatever is
+    // already queued. Spilled fills go out whenever the ring runs dry.
+    unsigned idle_rounds = 0;
+    while (true) {
+        if (poll_commands(*ingress_)) {
+            idle_rounds = 0;
+            continue;
+        }
+        flush_executions();
+        if (!running_.load(std::memory_order_acquire)) {
+            break;
+        }
+        idle(idle_rounds);
+    }
+}
+
+void MatchingEngine::idle(unsigned& rounds) {
+    switch (config_.idle_strategy) {
+        case IdleStrategy::BUSY_SPIN:
+            compiler_barrier();
+            break;
+        case IdleStrategy::PAUSE:
+            __builtin_ia32_pause();
+            break;
+        case IdleStrategy::BACKOFF:
+            backoff(rounds, MAX_BACKOFF_SHIFT);
+            break;
+        case IdleStrategy::PARK:
+            // Spilled fills only move when this thread flushes them, and a
+            // drain freeing ring space does not wake it, so stay awake
+            if (spill_head_ != spill_.size()) {
+                std::this_thread::yield();
+                break;
+            }
+            parked_.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ingress_->size() == 0 && running_.load(std::memory_order_relaxed)) {
+                futex_wait(parked_, 1);
+            }
+            parked_.store(0, std::memory_order_relaxed);
+            break;
+    }
+}
+
+Order* MatchingEngine::allocate_order() {
+    return order_pool_.allocate();
 }
 
 void MatchingEngine::deallocate_order(Order* order) {
-    // Simple pool management - could be improved
-    (void)order;
+    order_pool_.deallocate(order);
+}
+
+void MatchingEngine::release_order(void* engine, Order* order) {
+    auto* self = static_cast<MatchingEngine*>(engine);
+    self->order_directory_.erase(order->order_id, order);
+    self->deallocate_order(order);
+}
+
+Order* MatchingEngine::find_order(OrderBook* book, uint64_t order_id) noexcept {
+    if (!book) return nullptr;
+    Order* order = order_directory_.find(order_id);
+    return (order && order->book == book) ? order : nullptr;
+}
+
+bool MatchingEngine::push_report(const ExecutionReport& report) {
+    // Once anything has spilled, later fills queue behind it
+    const bool delivered = (spill_head_ == spill_.size() && execution_queue_.push(report)) ||
+                           push_report_full(report);
+    if (delivered) ++total_matches_;  // Dropped fills are counted separately
+    return delivered;
+}
+
+__attribute__((noinline))
+bool MatchingEngine::push_report_full(const ExecutionReport& report) {
+    switch (config_.execution_backpressure) {
+        case BackpressurePolicy::SPIN:
+            while (!execution_queue_.push(report)) __builtin_ia32_pause();
+            return true;
+        case BackpressurePolicy::YIELD:
+            while (!execution_queue_.push(report)) std::this_thread::yield();
+            return true;
+        case BackpressurePolicy::DROP:
+            ++dropped_reports_;
+            return false;
+        case BackpressurePolicy::SPILL:
+            break;
+    }
+    
+    if (flush_executions() == 0 && execution_queue_.push(report)) {
+        return true;
+    }
+    spill_.push_back(report);
+    ++spilled_reports_;
+    return true;
+}
+
+size_t MatchingEngine::flush_executions() noexcept {
+    while (spill_head_ < spill_.size() && execution_queue_.push(spill_[spill_head_])) {
+        ++spill_head_;
+    }
+    if (spill_head_ == spill_.size()) {
+        spill_.clear();  // Keeps its capacity for the next burst
+        spill_head_ = 0;
+    }
+    return spill_.size() - spill_head_;
+}
+
+bool MatchingEngine::start_execution_drain(ExecutionSink sink, int cpu) {
+    if (!sink || drain_thread_.joinable()) {
+        return false;
+    }
+    drain_sink_ = std::move(sink);
+    draining_.store(true, std::memory_order_release);
+    drain_thread_ = std::thread(&MatchingEngine::run_execution_drain, this, cpu);
+    return true;
+}
+
+void MatchingEngine::stop_execution_drain() {
+    if (!drain_thread_.joinable()) {
+        return;
+    }
+    
+    // The spill belongs to the thread applying commands; with an event
+    // loop running that is the loop, so stop it before touching the spill
+    if (loop_thread_.joinable()) stop();
+    
+    // Hand the spill over while the drain thread is still making room
+    while (flush_executions() != 0) std::this_thread::yield();
+    
+    draining_.store(false, std::memory_order_release);
+    drain_thread_.join();
+    drain_sink_ = nullptr;
+}
+
+void MatchingEngine::run_execution_drain(int cpu) {
+    if (cpu >= 0) {
+        set_cpu_affinity(cpu);
+    }
+    
+    // Pop in batches until stopped, then take whatever is left
+    ExecutionReport batch[DRAIN_BATCH];
+    unsigned rounds = 0;
+    while (true) {
+        const size_t count = execution_queue_.pop_n(batch, DRAIN_BATCH);
+        
+        if (count) {
+            drain_sink_(batch, count);
+            rounds = 0;
+        } else if (!draining_.load(std::memory_order_acquire)) {
+            if (execution_queue_.empty()) break;
+        } else {
+            backoff(rounds);
+        }
+    }
+}
+
+std::unique_ptr<HugePageArena> MatchingEngine::make_arena(const EngineConfig& config) {
+    if (!config.use_huge_page_arena) {
+        return nullptr;
+    }
+    
+    // Address space is reserved for every book up front; pages are only
+    // faulted in as the pools are carved out
+    const size_t order_bytes = config.order_pool_size * sizeof(Order);
+    const size_t level_bytes = config.num_symbols *
+        config.book_config.level_chunk_size * sizeof(PriceLevel);
+    return std::make_unique<HugePageArena>(order_bytes + level_bytes + CACHE_LINE_SIZE,
+                                           config.numa_node);
 }
 
 void MatchingEngine::setup_numa_affinity() {
@@ -1,6 +1,10 @@
 #include "order_book.hpp"
+#include "level_pool.hpp"
+#include "utils.hpp"
 #include <algorithm>
 #include <cassert>
+#include <iostream>
+#include <new>
 
 namespace lob {
 
@@ -48,89 +52,340 @@ void PriceLevel::remove_order(Order* order) noexcept {
     order->prev = nullptr;
 }
 
+namespace {
+
+// In-order traversal helpers for the price trees
+PriceLevel* tree_min(PriceLevel* node) noexcept {
+    if (node) {
+        while (node->left) node = node->left;
+    }
+    return node;
+}
+
+PriceLevel* tree_max(PriceLevel* node) noexcept {
+    if (node) {
+        while (node->right) node = node->right;
+    }
+    return node;
+}
+
+PriceLevel* tree_next(PriceLevel* node) noexcept {
+    if (node->right) return tree_min(node->right);
+    PriceLevel* parent = node->parent;
+    while (parent && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+PriceLevel* tree_lower_bound(PriceLevel* root, uint32_t price) noexcept {
+    PriceLevel* result = nullptr;
+    while (root) {
+        if (root->price >= price) {
+            result = root;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return result;
+}
+
+void rotate_left(PriceLevel*& root, PriceLevel* node) noexcept {
+    PriceLevel* pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) pivot->left->parent = node;
+    pivot->parent = node->parent;
+    if (!node->parent) {
+        root = pivot;
+    } else if (node == node->parent->left) {
+        node->parent->left = pivot;
+    } else {
+        node->parent->right = pivot;
+    }
+    pivot->left = node;
+    node->parent = pivot;
+}
+
+void rotate_right(PriceLevel*& root, PriceLevel* node) noexcept {
+    PriceLevel* pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) pivot->right->parent = node;
+    pivot->parent = node->parent;
+    if (!node->parent) {
+        root = pivot;
+    } else if (node == node->parent->right) {
+        node->parent->right = pivot;
+    } else {
+        node->parent->left = pivot;
+    }
+    pivot->right = node;
+    node->parent = pivot;
+}
+
+bool is_red(const PriceLevel* node) noexcept {
+    return node && node->is_red;
+}
+
+void insert_fixup(PriceLevel*& root, PriceLevel* node) noexcept {
+    while (is_red(node->parent)) {
+        PriceLevel* parent = node->parent;
+        PriceLevel* grandparent = parent->parent;
+        
+        if (parent == grandparent->left) {
+            PriceLevel* uncle = grandparent->right;
+            if (is_red(uncle)) {
+                parent->is_red = false;
+                uncle->is_red = false;
+                grandparent->is_red = true;
+                node = grandparent;
+            } else {
+                if (node == parent->right) {
+                    node = parent;
+                    rotate_left(root, node);
+                    parent = node->parent;
+                }
+                parent->is_red = false;
+                grandparent->is_red = true;
+                rotate_right(root, grandparent);
+            }
+        } else {
+            PriceLevel* uncle = grandparent->left;
+            if (is_red(uncle)) {
+                parent->is_red = false;
+                uncle->is_red = false;
+                grandparent->is_red = true;
+                node = grandparent;
+            } else {
+                if (node == parent->left) {
+                    node = parent;
+                    rotate_right(root, node);
+                    parent = node->parent;
+                }
+                parent->is_red = false;
+                grandparent->is_red = true;
+                rotate_left(root, grandparent);
+            }
+        }
+    }
+    root->is_red = false;
+}
+
+// `node` may be null, so its parent is tracked separately
+void erase_fixup(PriceLevel*& root, PriceLevel* node, PriceLevel* parent) noexcept {
+    while (node != root && !is_red(node)) {
+        if (node == parent->left) {
+            PriceLevel* sibling = parent->right;
+            if (is_red(sibling)) {
+                sibling->is_red = false;
+                parent->is_red = true;
+                rotate_left(root, parent);
+                sibling = parent->right;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->is_red = true;
+                node = parent;
+                parent = node->parent;
+            } else {
+                if (!is_red(sibling->right)) {
+                    sibling->left->is_red = false;
+                    sibling->is_red = true;
+                    rotate_right(root, sibling);
+                    sibling = parent->right;
+                }
+                sibling->is_red = parent->is_red;
+                parent->is_red = false;
+                if (sibling->right) sibling->right->is_red = false;
+                rotate_left(root, parent);
+                node = root;
+            }
+        } else {
+            PriceLevel* sibling = parent->left;
+            if (is_red(sibling)) {
+                sibling->is_red = false;
+                parent->is_red = true;
+                rotate_right(root, parent);
+                sibling = parent->left;
+            }
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->is_red = true;
+                node = parent;
+                parent = node->parent;
+            } else {
+                if (!is_red(sibling->left)) {
+                    sibling->right->is_red = false;
+                    sibling->is_red = true;
+                    rotate_left(root, sibling);
+                    sibling = parent->left;
+                }
+                sibling->is_red = parent->is_red;
+                parent->is_red = false;
+                if (sibling->left) sibling->left->is_red = false;
+                rotate_right(root, parent);
+                node = root;
+            }
+        }
+    }
+    if (node) node->is_red = false;
+}
+
+uint64_t tree_volume(PriceLevel* root) noexcept {
+    uint64_t volume = 0;
+    for (PriceLevel* level = tree_min(root); level; level = tree_next(level)) {
+        volume += level->total_volume;
+    }
+    return volume;
+}
+
+uint64_t ladder_volume(const PriceLadder& ladder) noexcept {
+    uint64_t volume = 0;
+    for (size_t i = ladder.next_occupied(0); i != OccupancyBitmap::npos;
+         i = ladder.next_occupied(i + 1)) {
+        volume += ladder.at(i)->total_volume;
+    }
+    return volume;
+}
+
+// Post-order so no freed node is read again
+void free_tree(PriceLevelPool& pool, PriceLevel* node) noexcept {
+    if (!node) return;
+    free_tree(pool, node->left);
+    free_tree(pool, node->right);
+    pool.deallocate(node);
+}
+
+void free_ladder(PriceLevelPool& pool, const PriceLadder& ladder) noexcept {
+    for (size_t i = ladder.next_occupied(0); i != OccupancyBitmap::npos;
+         i = ladder.next_occupied(i + 1)) {
+        pool.deallocate(ladder.at(i));
+    }
+}
+
+} // namespace
+
 // OrderBook implementation
-OrderBook::OrderBook()
-    : bid_tree_root_(nullptr), ask_tree_root_(nullptr),
+OrderBook::OrderBook() : OrderBook(BookConfig{}) {}
+
+OrderBook::OrderBook(const BookConfig& config)
+    : config_(config),
+      bid_tree_root_(nullptr), ask_tree_root_(nullptr),
       best_bid_(nullptr), best_ask_(nullptr),
-      pool_index_(0), order_count_(0), match_count_(0) {
+      levels_(config.level_pool), order_count_(0), match_count_(0) {
+    
+    if (config_.index_orders) {
+        orders_ = std::make_unique<OrderDirectory>(config_.order_directory,
+                                                   config_.order_capacity);
+    }
     
-    // Increased to 200k price levels (was 100k)
-    price_level_pool_.reserve(200000);
-    for (size_t i = 0; i < 200000; ++i) {
-        price_level_pool_.emplace_back(std::make_unique<PriceLevel>(0));
+    if (ladder_mode()) {
+        bid_ladder_.init(config_.tick_size, config_.ladder_size);
+        ask_ladder_.init(config_.tick_size, config_.ladder_size);
+        recenter_scratch_.reserve(bid_ladder_.size());
+    }
+    
+    // Levels are carved out lazily, chunk by chunk
+    if (!levels_) {
+        own_levels_ = std::make_unique<PriceLevelPool>(config_.level_chunk_size,
+                                                       config_.level_arena);
+        levels_ = own_levels_.get();
     }
 }
 
 
 OrderBook::~OrderBook() {
-    orders_.clear();
+    // Hand levels still in the book back to a shared pool
+    if (levels_ != own_levels_.get()) {
+        free_tree(*levels_, bid_tree_root_);
+        free_tree(*levels_, ask_tree_root_);
+        if (ladder_mode()) {
+            free_ladder(*levels_, bid_ladder_);
+            free_ladder(*levels_, ask_ladder_);
+        }
+    }
 }
 
-void OrderBook::add_order(Order* order) {
+bool OrderBook::add_order(Order* order) {
     if (!order) {  // ADD THIS CHECK
         std::cerr << "ERROR: Attempting to add null order" << std::endl;
-        return;
+        return false;
     }
     
     // Find or create price level
     PriceLevel* level = find_or_create_level(order->price, order->side);
     if (!level) {  // ADD THIS CHECK
         std::cerr << "ERROR: Failed to get price level for order " << order->order_id << std::endl;
-        return;
+        return false;
     }
     
     level->add_order(order);
+    order->book = this;
     
     // Update order lookup
-    orders_[order->order_id] = order;
+    if (orders_) orders_->insert(order->order_id, order);
     
     // Update best bid/ask
     if (order->side == Side::BUY) {
         if (!best_bid_ || level->price > best_bid_->price) {
             best_bid_ = level;
+            if (ladder_mode() && !bid_ladder_.covers(level->price)) {
+                recenter_ladder(Side::BUY, level->price);
+            }
         }
     } else {
         if (!best_ask_ || level->price < best_ask_->price) {
             best_ask_ = level;
+            if (ladder_mode() && !ask_ladder_.covers(level->price)) {
+                recenter_ladder(Side::SELL, level->price);
+            }
         }
     }
     
     ++order_count_;
+    return true;
 }
 
 void OrderBook::cancel_order(uint64_t order_id) {
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) return;
+    Order* order = orders_ ? orders_->find(order_id) : nullptr;
+    if (!order) return;
+    
+    cancel_order(order);
+}
+
+void OrderBook::cancel_order(Order* order) {
+    if (orders_) orders_->extract(order->order_id);
     
-    Order* order = it->second;
     PriceLevel* level = order->parent_level;
     
     level->remove_order(order);
     
     // Remove empty price level
     if (level->order_count == 0) {
+        detach_level(level, order->side);
         if (order->side == Side::BUY) {
-            remove_level(level, bid_tree_root_);
             if (level == best_bid_) {
                 update_best_bid();
             }
         } else {
-            remove_level(level, ask_tree_root_);
             if (level == best_ask_) {
                 update_best_ask();
             }
         }
+        free_level(level);
     }
     
-    orders_.erase(it);
     --order_count_;
+    release_order(order);
 }
 
 void OrderBook::modify_order(uint64_t order_id, uint32_t new_quantity) {
-    auto it = orders_.find(order_id);
-    if (it == orders_.end()) return;
+    Order* order = orders_ ? orders_->find(order_id) : nullptr;
+    if (!order) return;
     
-    Order* order = it->second;
+    modify_order(order, new_quantity);
+}
+
+void OrderBook::modify_order(Order* order, uint32_t new_quantity) noexcept {
     PriceLevel* level = order->parent_level;
     
     level->total_volume -= order->remaining_quantity;
@@ -138,86 +393,54 @@ void OrderBook::modify_order(uint64_t order_id, uint32_t new_quantity) {
     level->total_volume += new_quantity;
 }
 
-std::vector<ExecutionReport> OrderBook::match_order(Order* order) {
-    std::vector<ExecutionReport> reports;
-    
-    if (order->type != OrderType::LIMIT && order->type != OrderType::MARKET) {
-        return reports;
+void OrderBook::reduce_order(Order* order, uint32_t quantity) {
+    if (quantity >= order->remaining_quantity) {
+        cancel_order(order);
+        return;
     }
     
-    PriceLevel* contra_level = (order->side == Side::BUY) ? best_ask_ : best_bid_;
+    order->remaining_quantity -= quantity;
+    order->parent_level->total_volume -= quantity;
+}
+
+ExecutionReport OrderBook::execute_order(Order* order, uint32_t quantity,
+                                         uint32_t price, uint64_t timestamp) {
+    quantity = std::min(quantity, order->remaining_quantity);
+    ExecutionReport report(order->order_id, ++match_count_, timestamp, price, quantity,
+                           order->side, quantity == order->remaining_quantity);
+    reduce_order(order, quantity);
+    return report;
+}
+
+std::vector<ExecutionReport> OrderBook::match_order(Order* order) {
+    std::vector<ExecutionReport> reports;
+    match_order(order, [&reports](const ExecutionReport& report) {
+        reports.push_back(report);
+    });
+    return reports;
+}
+
+PriceLevel* OrderBook::find_or_create_level(uint32_t price, Side side) {
+    PriceLevel*& root = (side == Side::BUY) ? bid_tree_root_ : ask_tree_root_;
     
-    while (order->remaining_quantity > 0 && contra_level) {
-        // Check price crossing
-        if (order->type == OrderType::LIMIT) {
-            if (order->side == Side::BUY && order->price < contra_level->price) break;
-            if (order->side == Side::SELL && order->price > contra_level->price) break;
-        }
+    if (ladder_mode()) {
+        PriceLadder& ladder = (side == Side::BUY) ? bid_ladder_ : ask_ladder_;
         
-        Order* passive = contra_level->head_order;
-        while (passive && order->remaining_quantity > 0) {
-            uint32_t match_qty = std::min(order->remaining_quantity, 
-                                         passive->remaining_quantity);
-            
-            // Generate execution report
-            uint64_t match_id = ++match_count_;
-            reports.push_back(execute_trade(order, passive, match_qty, match_id));
-            
-            // Update quantities
-            order->remaining_quantity -= match_qty;
-            passive->remaining_quantity -= match_qty;
-            contra_level->total_volume -= match_qty;
-            
-            Order* next_passive = passive->next;
-            
-            // Remove fully filled passive order
-            if (passive->remaining_quantity == 0) {
-                contra_level->remove_order(passive);
-                orders_.erase(passive->order_id);
-                --order_count_;
-            }
-            
-            passive = next_passive;
+        // Empty side - move the window to the first price for free
+        if (ladder.empty() && !root && !ladder.covers(price)) {
+            ladder.recenter(price);
         }
         
-        // Move to next price level if current is depleted
-        if (contra_level->order_count == 0) {
-            PriceLevel* next_level = (order->side == Side::BUY) 
-                ? contra_level->right  // Next higher ask
-                : contra_level->left;  // Next lower bid
-            
-            if (order->side == Side::BUY) {
-                remove_level(contra_level, ask_tree_root_);
-                best_ask_ = next_level;
-            } else {
-                remove_level(contra_level, bid_tree_root_);
-                best_bid_ = next_level;
+        if (ladder.covers(price)) {
+            PriceLevel* level = ladder.get(price);
+            if (!level) {
+                level = allocate_level(price);
+                ladder.set(price, level);
             }
-            
-            contra_level = next_level;
-        } else {
-            break;
+            return level;
         }
     }
     
-    return reports;
-}
-
-ExecutionReport OrderBook::execute_trade(Order* aggressive, Order* passive,
-                                        uint32_t quantity, uint64_t match_id) {
-    return ExecutionReport(
-        aggressive->order_id,
-        match_id,
-        aggressive->timestamp,
-        passive->price, // Trade at passive price
-        quantity,
-        aggressive->side,
-        aggressive->remaining_quantity == quantity
-    );
-}
-
-PriceLevel* OrderBook::find_or_create_level(uint32_t price, Side side) {
-    PriceLevel*& root = (side == Side::BUY) ? bid_tree_root_ : ask_tree_root_;
     PriceLevel* level = find_level(price, root);
     
     if (!level) {
@@ -240,108 +463,193 @@ PriceLevel* OrderBook::find_level(uint32_t price, PriceLevel* root) {
     return nullptr;
 }
 
+PriceLevel* OrderBook::allocate_level(uint32_t price) {
+    return levels_->allocate(price);
+}
+
+void OrderBook::free_level(PriceLevel* level) noexcept {
+    levels_->deallocate(level);
+}
+
 PriceLevel* OrderBook::insert_level(uint32_t price, PriceLevel*& root) {
-    // REMOVE: assert(pool_index_ < price_level_pool_.size());
-    
-    // ADD: Proper bounds checking with error handling
-    if (pool_index_ >= price_level_pool_.size()) {
-        static bool warned = false;
-        if (!warned) {
-            std::cerr << "WARNING: Price level pool exhausted (size: " 
-                      << price_level_pool_.size() << "). Reusing levels." << std::endl;
-            warned = true;
-        }
-        // Wrap around - reuse old levels (simple recycling)
-        pool_index_ = 0;
-    }
-    
-    PriceLevel* new_level = price_level_pool_[pool_index_++].get();
-    new_level->price = price;
-    new_level->total_volume = 0;
-    new_level->order_count = 0;
-    new_level->head_order = nullptr;
-    new_level->tail_order = nullptr;
-    new_level->parent = nullptr;
-    new_level->left = nullptr;
-    new_level->right = nullptr;
+    PriceLevel* new_level = allocate_level(price);
+    link_level(new_level, root);
+    return new_level;
+}
+
+void OrderBook::link_level(PriceLevel* level, PriceLevel*& root) {
+    level->parent = nullptr;
+    level->left = nullptr;
+    level->right = nullptr;
+    level->is_red = true;
     
     if (!root) {
-        root = new_level;
-        return new_level;
+        root = level;
+        level->is_red = false;
+        return;
     }
     
     PriceLevel* current = root;
     while (true) {
-        if (price < current->price) {
+        if (level->price < current->price) {
             if (!current->left) {
-                current->left = new_level;
-                new_level->parent = current;
-                return new_level;
+                current->left = level;
+                break;
             }
             current = current->left;
         } else {
             if (!current->right) {
-                current->right = new_level;
-                new_level->parent = current;
-                return new_level;
+                current->right = level;
+                break;
             }
             current = current->right;
         }
     }
+    
+    level->parent = current;
+    insert_fixup(root, level);
 }
 
 
 void OrderBook::remove_level(PriceLevel* level, PriceLevel*& root) {
-    // Simple BST deletion (can be optimized with balanced tree)
-    if (!level->left && !level->right) {
-        if (level->parent) {
-            if (level->parent->left == level) level->parent->left = nullptr;
-            else level->parent->right = nullptr;
-        } else {
-            root = nullptr;
-        }
-    } else if (!level->left) {
-        if (level->parent) {
-            if (level->parent->left == level) level->parent->left = level->right;
-            else level->parent->right = level->right;
+    // Red-black deletion. Nodes are relinked rather than copied so that
+    // resting orders keep valid parent_level pointers.
+    auto transplant = [&root](PriceLevel* node, PriceLevel* child) {
+        if (!node->parent) {
+            root = child;
+        } else if (node->parent->left == node) {
+            node->parent->left = child;
         } else {
-            root = level->right;
+            node->parent->right = child;
         }
-        if (level->right) level->right->parent = level->parent;
+        if (child) child->parent = node->parent;
+    };
+    
+    bool removed_red = level->is_red;
+    PriceLevel* child;
+    PriceLevel* child_parent;
+    
+    if (!level->left) {
+        child = level->right;
+        child_parent = level->parent;
+        transplant(level, level->right);
     } else if (!level->right) {
-        if (level->parent) {
-            if (level->parent->left == level) level->parent->left = level->left;
-            else level->parent->right = level->left;
+        child = level->left;
+        child_parent = level->parent;
+        transplant(level, level->left);
+    } else {
+        // Splice the in-order successor into the removed node's position
+        PriceLevel* successor = tree_min(level->right);
+        removed_red = successor->is_red;
+        child = successor->right;
+        
+        if (successor->parent == level) {
+            child_parent = successor;
         } else {
-            root = level->left;
+            child_parent = successor->parent;
+            transplant(successor, successor->right);
+            successor->right = level->right;
+            successor->right->parent = successor;
         }
-        if (level->left) level->left->parent = level->parent;
+        transplant(level, successor);
+        successor->left = level->left;
+        successor->left->parent = successor;
+        successor->is_red = level->is_red;
+    }
+    
+    if (!removed_red) {
+        erase_fixup(root, child, child_parent);
+    }
+    
+    level->parent = nullptr;
+    level->left = nullptr;
+    level->right = nullptr;
+    level->is_red = false;
+}
+
+void OrderBook::detach_level(PriceLevel* level, Side side) {
+    PriceLadder& ladder = (side == Side::BUY) ? bid_ladder_ : ask_ladder_;
+    
+    if (ladder_mode() && ladder.covers(level->price)) {
+        ladder.clear(level->price);
     } else {
-        // Find in-order successor
-        PriceLevel* successor = level->right;
-        while (successor->left) successor = successor->left;
-        
-        level->price = successor->price;
-        level->total_volume = successor->total_volume;
-        level->order_count = successor->order_count;
-        level->head_order = successor->head_order;
-        level->tail_order = successor->tail_order;
-        
-        remove_level(successor, root);
+        remove_level(level, (side == Side::BUY) ? bid_tree_root_ : ask_tree_root_);
+    }
+}
+
+void OrderBook::recenter_ladder(Side side, uint32_t center) {
+    PriceLadder& ladder = (side == Side::BUY) ? bid_ladder_ : ask_ladder_;
+    PriceLevel*& root = (side == Side::BUY) ? bid_tree_root_ : ask_tree_root_;
+    
+    // At most ladder.size() levels either way, within the reservation
+    std::vector<PriceLevel*>& moved = recenter_scratch_;
+    moved.clear();
+    for (size_t i = ladder.next_occupied(0); i != OccupancyBitmap::npos;
+         i = ladder.next_occupied(i + 1)) {
+        moved.push_back(ladder.at(i));
+    }
+    
+    ladder.recenter(center);
+    
+    // Levels that fell out of the window go to the tree
+    for (PriceLevel* level : moved) {
+        if (ladder.covers(level->price)) {
+            ladder.set(level->price, level);
+        } else {
+            link_level(level, root);
+        }
+    }
+    
+    // Levels the window now covers come out of the tree
+    moved.clear();
+    const uint32_t hi = ladder.price_at(ladder.size() - 1);
+    for (PriceLevel* level = tree_lower_bound(root, ladder.base());
+         level && level->price <= hi; level = tree_next(level)) {
+        if (ladder.covers(level->price)) moved.push_back(level);
+    }
+    for (PriceLevel* level : moved) {
+        remove_level(level, root);
+        ladder.set(level->price, level);
     }
 }
 
 void OrderBook::update_best_bid() {
-    best_bid_ = bid_tree_root_;
-    if (best_bid_) {
-        while (best_bid_->right) best_bid_ = best_bid_->right;
+    PriceLevel* best = tree_max(bid_tree_root_);
+    
+    if (ladder_mode() && !bid_ladder_.empty()) {
+        // Nothing in the ladder sits above the previous best
+        PriceLevel* ladder_best = (best_bid_ && bid_ladder_.covers(best_bid_->price))
+            ? bid_ladder_.highest_at_or_below(best_bid_->price)
+            : bid_ladder_.highest();
+        if (ladder_best && (!best || ladder_best->price > best->price)) {
+            best = ladder_best;
+        }
+    }
+    
+    best_bid_ = best;
+    
+    if (ladder_mode() && best && !bid_ladder_.covers(best->price)) {
+        recenter_ladder(Side::BUY, best->price);
     }
 }
 
 void OrderBook::update_best_ask() {
-    best_ask_ = ask_tree_root_;
-    if (best_ask_) {
-        while (best_ask_->left) best_ask_ = best_ask_->left;
+    PriceLevel* best = tree_min(ask_tree_root_);
+    
+    if (ladder_mode() && !ask_ladder_.empty()) {
+        // Nothing in the ladder sits below the previous best
+        PriceLevel* ladder_best = (best_ask_ && ask_ladder_.covers(best_ask_->price))
+            ? ask_ladder_.lowest_at_or_above(best_ask_->price)
+            : ask_ladder_.lowest();
+        if (ladder_best && (!best || ladder_best->price < best->price)) {
+            best = ladder_best;
+        }
+    }
+    
+    best_ask_ = best;
+    
+    if (ladder_mode() && best && !ask_ladder_.covers(best->price)) {
+        recenter_ladder(Side::SELL, best->price);
     }
 }
 
@@ -351,23 +659,11 @@ uint32_t OrderBook::get_spread() const noexcept {
 }
 
 uint64_t OrderBook::get_total_bid_volume() const noexcept {
-    uint64_t volume = 0;
-    PriceLevel* level = bid_tree_root_;
-    while (level) {
-        volume += level->total_volume;
-        level = level->right;
-    }
-    return volume;
+    return tree_volume(bid_tree_root_) + (ladder_mode() ? ladder_volume(bid_ladder_) : 0);
 }
 
 uint64_t OrderBook::get_total_ask_volume() const noexcept {
-    uint64_t volume = 0;
-    PriceLevel* level = ask_tree_root_;
-    while (level) {
-        volume += level->total_volume;
-        level = level->left;
-    }
-    return volume;
+    return tree_volume(ask_tree_root_) + (ladder_mode() ? ladder_volume(ask_ladder_) : 0);
 }
 
 } // namespace lob
@@ -0,0 +1,98 @@
+#include "order_pool.hpp"
+#include "utils.hpp"
+#include <new>
+
+namespace lob {
+
+OrderPool::OrderPool(size_t capacity, HugePageArena* arena)
+    : slab_(nullptr), capacity_(capacity), owns_slab_(false) {
+    
+    void* mem = arena ? arena->allocate(capacity * sizeof(Order), alignof(Order)) : nullptr;
+    if (!mem) {
+        mem = ::operator new(capacity * sizeof(Order), std::align_val_t(alignof(Order)));
+        owns_slab_ = true;
+    }
+    
+    slab_ = static_cast<Order*>(mem);
+    for (size_t i = 0; i < capacity; ++i) {
+        new (&slab_[i]) Order();
+    }
+}
+
+OrderPool::~OrderPool() {
+    // Order is trivially destructible; the arena owns its own memory
+    if (owns_slab_) {
+        ::operator delete(slab_, std::align_val_t(alignof(Order)));
+    }
+}
+
+void OrderPool::lock() noexcept {
+    while (lock_.test_and_set(std::memory_order_acquire)) {
+        __builtin_ia32_pause();
+    }
+}
+
+size_t OrderPool::take_batch(Order*& head, size_t max_count) noexcept {
+    lock();
+
+    size_t count = 0;
+    head = nullptr;
+    while (count < max_count) {
+        Order* order = free_list_;
+        if (order) {
+            free_list_ = order->next;
+        } else if (next_unused_ < capacity_) {
+            order = &slab_[next_unused_++];
+        } else {
+            break;
+        }
+        order->next = head;
+        head = order;
+        ++count;
+    }
+    in_use_ += count;
+
+    unlock();
+    return count;
+}
+
+void OrderPool::give_batch(Order* head, Order* tail, size_t count) noexcept {
+    lock();
+    tail->next = free_list_;
+    free_list_ = head;
+    in_use_ -= count;
+    unlock();
+}
+
+OrderPool::ThreadCache::~ThreadCache() {
+    flush(0);
+}
+
+void OrderPool::ThreadCache::flush(size_t keep) noexcept {
+    if (count_ <= keep) return;
+
+    // Hand everything past the first `keep` orders back to the pool
+    Order* last_kept = nullptr;
+    Order* head = head_;
+    for (size_t i = 0; i < keep; ++i) {
+        last_kept = head;
+        head = head->next;
+    }
+
+    Order* tail = head;
+    size_t count = 1;
+    while (tail->next) {
+        tail = tail->next;
+        ++count;
+    }
+
+    if (last_kept) {
+        last_kept->next = nullptr;
+    } else {
+        head_ = nullptr;
+    }
+    count_ = keep;
+    pool_.give_batch(head, tail, count);
+}
+
+} // namespace lob
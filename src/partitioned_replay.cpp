@@ -0,0 +1,295 @@
+#include "partitioned_replay.hpp"
+#include "utils.hpp"
+#include <iostream>
+#include <fstream>
+#include <array>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lob {
+
+namespace {
+
+constexpr uint64_t INDEX_MAGIC = 0x4C4F42494458ULL;  // "LOBIDX"
+constexpr uint32_t INDEX_VERSION = 1;
+
+// Index file: this header, num_partitions message counts, then each
+// partition's message offsets in file order
+struct IndexHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t num_partitions;
+    uint64_t file_size;   // Of the ITCH file the offsets point into
+};
+
+// Read-only mapping of a whole file
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() {
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    bool open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+        void* mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);  // The mapping keeps the file open
+        if (mapping == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        data = static_cast<const uint8_t*>(mapping);
+        if (data) madvise(mapping, size, MADV_WILLNEED);
+        return true;
+    }
+};
+
+// Call fn(offset, stock_locate) for each complete length-prefixed message.
+// Every ITCH message carries its locate right after the type byte; one
+// too short to have it goes to locate 0.
+template<typename Fn>
+void for_each_message(const uint8_t* data, size_t size, Fn&& fn) {
+    size_t offset = 0;
+    while (offset + sizeof(uint16_t) < size) {
+        uint16_t length;
+        std::memcpy(&length, data + offset, sizeof(length));
+        const size_t msg_length = __builtin_bswap16(length);
+        if (msg_length == 0 || offset + sizeof(uint16_t) + msg_length > size) break;
+
+        uint16_t stock_locate = 0;
+        if (msg_length >= 1 + sizeof(stock_locate)) {
+            std::memcpy(&stock_locate, data + offset + sizeof(uint16_t) + 1, sizeof(stock_locate));
+            stock_locate = __builtin_bswap16(stock_locate);
+        }
+        fn(offset, stock_locate);
+        offset += sizeof(uint16_t) + msg_length;
+    }
+}
+
+} // namespace
+
+ReplayStats& ReplayStats::operator+=(const ReplayStats& other) noexcept {
+    messages += other.messages;
+    total_orders += other.total_orders;
+    total_matches += other.total_matches;
+    rejected_orders += other.rejected_orders;
+    resting_orders += other.resting_orders;
+    trades.trades += other.trades.trades;
+    trades.trade_volume += other.trades.trade_volume;
+    trades.cross_trades += other.trades.cross_trades;
+    trades.cross_volume += other.trades.cross_volume;
+    trades.broken_trades += other.trades.broken_trades;
+    return *this;
+}
+
+PartitionedReplay::PartitionedReplay(const PartitionedReplayConfig& config)
+    : config_(config) {
+
+    const size_t num_partitions = config_.num_partitions ? config_.num_partitions : 1;
+    config_.engine_config.cpu_affinity = -1;       // Pinned here, not by the engine
+    config_.engine_config.run_event_loop = false;  // Workers apply directly
+
+    partitions_.reserve(num_partitions);
+    for (size_t i = 0; i < num_partitions; ++i) {
+        partitions_.push_back(std::make_unique<Partition>());
+    }
+
+    // Build each engine on its partition's core, so the books and pools
+    // are first touched where they are used
+    std::vector<std::thread> builders;
+    for (size_t i = 0; i < num_partitions; ++i) {
+        builders.emplace_back([this, i] {
+            pin_partition(i);
+            Partition& partition = *partitions_[i];
+            partition.engine = std::make_unique<MatchingEngine>(config_.engine_config);
+            partition.feed = std::make_unique<FeedHandler>(*partition.engine);
+        });
+    }
+    for (auto& builder : builders) builder.join();
+}
+
+PartitionedReplay::~PartitionedReplay() = default;
+
+bool PartitionedReplay::replay(const std::string& filename, const std::string& index_path) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Failed to map ITCH file: " << filename << std::endl;
+        return false;
+    }
+
+    // Use the index only if it was built for this file and partition count
+    MappedFile index;
+    const IndexHeader* header = nullptr;
+    const uint64_t* counts = nullptr;
+    if (!index_path.empty()) {
+        const size_t counts_end = sizeof(IndexHeader) + partitions_.size() * sizeof(uint64_t);
+        if (index.open(index_path) && index.size >= counts_end) {
+            header = reinterpret_cast<const IndexHeader*>(index.data);
+            counts = reinterpret_cast<const uint64_t*>(index.data + sizeof(IndexHeader));
+            uint64_t total = 0;
+            for (size_t i = 0; i < partitions_.size(); ++i) total += counts[i];
+            if (header->magic != INDEX_MAGIC || header->version != INDEX_VERSION ||
+                header->num_partitions != partitions_.size() || header->file_size != file.size ||
+                index.size != counts_end + total * sizeof(uint64_t)) {
+                header = nullptr;
+            }
+        }
+        if (!header) {
+            std::cerr << "WARNING: Partition index " << index_path
+                      << " does not match, routing instead" << std::endl;
+        }
+    }
+
+    const uint64_t start_time = get_timestamp_ns();
+    if (header) {
+        const uint64_t* offsets = counts + partitions_.size();
+        for (size_t i = 0; i < partitions_.size(); ++i) {
+            partitions_[i]->worker = std::thread(&PartitionedReplay::run_indexed, this, i,
+                                                 file.data, file.size, offsets, counts[i]);
+            offsets += counts[i];
+        }
+    } else {
+        routed_.store(false, std::memory_order_relaxed);
+        for (size_t i = 0; i < partitions_.size(); ++i) {
+            partitions_[i]->worker = std::thread(&PartitionedReplay::run_routed, this, i,
+                                                 file.data, file.size);
+        }
+
+        // Route offsets in batches; a partition's ring only ever sees its
+        // own locates, in file order
+        std::vector<std::array<uint64_t, ROUTE_BATCH>> batches(partitions_.size());
+        std::vector<size_t> batched(partitions_.size(), 0);
+        auto flush = [this, &batches, &batched](size_t index) {
+            SPSCQueue<uint64_t>& ring = partitions_[index]->offsets;
+            size_t pushed = 0;
+            unsigned rounds = 0;
+            while (pushed < batched[index]) {
+                const size_t n = ring.push_n(batches[index].data() + pushed,
+                                             batched[index] - pushed);
+                if (n == 0) backoff(rounds);  // Partition is behind
+                pushed += n;
+            }
+            batched[index] = 0;
+        };
+        for_each_message(file.data, file.size,
+                         [this, &batches, &batched, &flush](uint64_t offset, uint16_t stock_locate) {
+            const size_t index = partition_of(stock_locate);
+            batches[index][batched[index]] = offset;
+            if (++batched[index] == ROUTE_BATCH) flush(index);
+        });
+        for (size_t i = 0; i < partitions_.size(); ++i) flush(i);
+        routed_.store(true, std::memory_order_release);
+    }
+
+    for (auto& partition : partitions_) partition->worker.join();
+
+    // End-of-run merge
+    stats_ = ReplayStats{};
+    for (const auto& partition : partitions_) stats_ += partition->stats;
+    stats_.elapsed_ns = get_timestamp_ns() - start_time;
+    return true;
+}
+
+bool PartitionedReplay::build_index(const std::string& filename, size_t num_partitions,
+                                    const std::string& index_path) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Failed to map ITCH file: " << filename << std::endl;
+        return false;
+    }
+    if (num_partitions == 0) num_partitions = 1;
+
+    std::vector<std::vector<uint64_t>> offsets(num_partitions);
+    for_each_message(file.data, file.size, [&offsets, num_partitions](uint64_t offset,
+                                                                      uint16_t stock_locate) {
+        offsets[stock_locate % num_partitions].push_back(offset);
+    });
+
+    IndexHeader header{INDEX_MAGIC, INDEX_VERSION, static_cast<uint32_t>(num_partitions),
+                       file.size};
+    std::ofstream out(index_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& partition : offsets) {
+        const uint64_t count = partition.size();
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    for (const auto& partition : offsets) {
+        out.write(reinterpret_cast<const char*>(partition.data()),
+                  partition.size() * sizeof(uint64_t));
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Failed to write partition index: " << index_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PartitionedReplay::run_routed(size_t index, const uint8_t* data, size_t size) {
+    pin_partition(index);
+    Partition& partition = *partitions_[index];
+    const uint64_t start_time = get_timestamp_ns();
+
+    uint64_t batch[ROUTE_BATCH];
+    unsigned rounds = 0;
+    while (true) {
+        // Read the flag first: once set, everything it covers is in the ring
+        const bool finished = routed_.load(std::memory_order_acquire);
+        const size_t count = partition.offsets.pop_n(batch, ROUTE_BATCH);
+        if (count) {
+            partition.feed->replay_itch_messages(data, size, batch, count);
+            rounds = 0;
+        } else if (finished) {
+            break;
+        } else {
+            backoff(rounds);
+        }
+    }
+
+    collect_stats(index, get_timestamp_ns() - start_time);
+}
+
+void PartitionedReplay::run_indexed(size_t index, const uint8_t* data, size_t size,
+                                    const uint64_t* offsets, size_t count) {
+    pin_partition(index);
+    const uint64_t start_time = get_timestamp_ns();
+    const size_t processed = partitions_[index]->feed->replay_itch_messages(data, size,
+                                                                            offsets, count);
+    collect_stats(index, get_timestamp_ns() - start_time);
+    if (processed != count) {
+        std::cerr << "WARNING: Partition " << index << " index offset " << processed
+                  << " is not a message in the file, stopped early" << std::endl;
+    }
+}
+
+void PartitionedReplay::pin_partition(size_t index) const {
+    if (index < config_.partition_cores.size() && config_.partition_cores[index] >= 0) {
+        set_cpu_affinity(config_.partition_cores[index]);
+    }
+}
+
+void PartitionedReplay::collect_stats(size_t index, uint64_t elapsed_ns) {
+    Partition& partition = *partitions_[index];
+    const MatchingEngine& engine = *partition.engine;
+    ReplayStats& stats = partition.stats;
+    stats.messages = partition.feed->get_messages_processed();
+    stats.total_orders = engine.get_total_orders();
+    stats.total_matches = engine.get_total_matches();
+    stats.rejected_orders = engine.get_rejected_orders();
+    stats.resting_orders = engine.get_orders_in_use();
+    stats.trades = partition.feed->get_trade_stats();
+    stats.elapsed_ns = elapsed_ns;
+}
+
+} // namespace lob
@@ -0,0 +1,100 @@
+#include "sharded_engine.hpp"
+#include "utils.hpp"
+#include <iostream>
+
+namespace lob {
+
+ShardedEngine::ShardedEngine(const ShardedEngineConfig& config)
+    : config_(config), running_(true) {
+    
+    const size_t num_shards = config_.num_shards ? config_.num_shards : 1;
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    
+    // Each worker builds its own engine after pinning, so the books and
+    // pools are first touched on the core that uses them
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_[i]->worker = std::thread(&ShardedEngine::run_shard, this, i);
+    }
+    for (auto& shard : shards_) {
+        unsigned rounds = 0;
+        while (!shard->ready.load(std::memory_order_acquire)) backoff(rounds);
+    }
+    
+    std::cout << "Sharded engine started with " << num_shards << " shards" << std::endl;
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+void ShardedEngine::submit(const EngineCommand& command) noexcept {
+    Shard& shard = *shards_[shard_of(command.stock_locate)];
+    unsigned rounds = 0;
+    while (!shard.commands.push(command)) backoff(rounds);
+    ++shard.submitted;
+}
+
+void ShardedEngine::drain() const noexcept {
+    for (const auto& shard : shards_) {
+        unsigned rounds = 0;
+        while (shard->applied.load(std::memory_order_acquire) != shard->submitted) backoff(rounds);
+    }
+}
+
+uint64_t ShardedEngine::get_total_orders() const noexcept {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) total += shard->engine->get_total_orders();
+    return total;
+}
+
+uint64_t ShardedEngine::get_total_matches() const noexcept {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) total += shard->engine->get_total_matches();
+    return total;
+}
+
+void ShardedEngine::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) return;
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+}
+
+void ShardedEngine::run_shard(size_t index) {
+    Shard& shard = *shards_[index];
+    
+    EngineConfig engine_config = config_.engine_config;
+    engine_config.cpu_affinity = -1;  // Pinned here, not by the engine
+    engine_config.run_event_loop = false;  // This worker is the only thread applying commands
+    if (index < config_.shard_cores.size() && config_.shard_cores[index] >= 0) {
+        set_cpu_affinity(config_.shard_cores[index]);
+    }
+    shard.engine = std::make_unique<MatchingEngine>(engine_config);
+    shard.engine->start();
+    shard.ready.store(true, std::memory_order_release);
+    
+    // Apply commands in batches until stopped, finishing whatever is
+    // already queued
+    uint64_t applied = 0;
+    unsigned rounds = 0;
+    while (true) {
+        const size_t count = shard.engine->poll_commands(shard.commands, WORKER_BATCH);
+        if (count) {
+            applied += count;
+            shard.applied.store(applied, std::memory_order_release);
+            rounds = 0;
+        } else if (!running_.load(std::memory_order_acquire)) {
+            break;
+        } else {
+            shard.engine->flush_executions();  // Spilled fills, as the router polls
+            backoff(rounds);
+        }
+    }
+    
+    shard.engine->stop();
+}
+
+} // namespace lob
@@ -0,0 +1,114 @@
+#include "symbol_directory.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace lob {
+
+namespace {
+
+constexpr uint32_t MIN_SLOT_BITS = 4;
+constexpr uint32_t MAX_SEED_TRIES = 1 << 16;
+
+} // namespace
+
+SymbolId SymbolDirectory::insert(SymbolKey key) {
+    if (key == 0) return SymbolId{};
+
+    SymbolId existing = find(key);
+    if (existing.valid()) return existing;
+
+    const uint32_t id = static_cast<uint32_t>(keys_.size());
+    keys_.push_back(key);
+
+    // Keep the table at most half full so buckets stay easy to place
+    if (keys_.size() * 2 > slots_.size()) {
+        rebuild();
+        return SymbolId{id};
+    }
+
+    Slot& slot = slots_[slot_of(key, seeds_[bucket_of(key)])];
+    if (slot.key == 0) {
+        slot.key = key;
+        slot.id = id;
+    } else {
+        rebuild();
+    }
+    return SymbolId{id};
+}
+
+void SymbolDirectory::load(const std::vector<SymbolKey>& keys) {
+    std::vector<SymbolKey> fresh;
+    fresh.reserve(keys.size());
+    for (SymbolKey key : keys) {
+        if (key != 0 && !find(key).valid()) fresh.push_back(key);
+    }
+
+    // Drop duplicates within the batch, keeping first-seen order for ids
+    std::unordered_set<SymbolKey> seen;
+    seen.reserve(fresh.size());
+    for (SymbolKey key : fresh) {
+        if (seen.insert(key).second) keys_.push_back(key);
+    }
+
+    rebuild();
+}
+
+void SymbolDirectory::rebuild() {
+    uint32_t bits = MIN_SLOT_BITS;
+    while ((size_t{1} << bits) < keys_.size() * 2) ++bits;
+    while (!try_build(bits)) ++bits;
+    ++rebuilds_;
+}
+
+bool SymbolDirectory::try_build(uint32_t slot_bits) {
+    slot_bits_ = slot_bits;
+    bucket_bits_ = slot_bits - 2;  // ~2 keys per bucket at full load
+
+    const size_t num_buckets = size_t{1} << bucket_bits_;
+    std::vector<std::vector<uint32_t>> buckets(num_buckets);
+    for (uint32_t id = 0; id < keys_.size(); ++id) {
+        buckets[bucket_of(keys_[id])].push_back(id);
+    }
+
+    // Biggest buckets first, while the table is still empty
+    std::vector<uint32_t> order(num_buckets);
+    for (uint32_t b = 0; b < num_buckets; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    slots_.assign(size_t{1} << slot_bits_, Slot{});
+    seeds_.assign(num_buckets, 0);
+
+    std::vector<size_t> placed;
+    for (uint32_t b : order) {
+        const std::vector<uint32_t>& ids = buckets[b];
+        if (ids.empty()) break;
+
+        bool done = false;
+        for (uint32_t seed = 0; seed < MAX_SEED_TRIES && !done; ++seed) {
+            placed.clear();
+            done = true;
+            for (uint32_t id : ids) {
+                const size_t slot = slot_of(keys_[id], seed);
+                if (slots_[slot].key != 0 ||
+                    std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+                    done = false;
+                    break;
+                }
+                placed.push_back(slot);
+            }
+            if (done) {
+                seeds_[b] = seed;
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    slots_[placed[i]].key = keys_[ids[i]];
+                    slots_[placed[i]].id = ids[i];
+                }
+            }
+        }
+        if (!done) return false;
+    }
+    return true;
+}
+
+} // namespace lob
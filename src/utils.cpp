@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <iostream>      // ADD THIS
 #include <vector>        // ADD THIS
+#include <cerrno>
 
 #ifdef __linux__
 #include <sched.h>
@@ -15,6 +16,23 @@
 
 namespace lob {
 
+namespace {
+
+// Bind a fresh mapping to a NUMA node before any of it is faulted in
+void bind_to_node(void* ptr, size_t size, int numa_node) {
+#ifdef __linux__
+    if (numa_node >= 0 && numa_available() >= 0) {
+        numa_tonode_memory(ptr, size, numa_node);
+    }
+#else
+    (void)ptr;
+    (void)size;
+    (void)numa_node;
+#endif
+}
+
+} // namespace
+
 void set_cpu_affinity(int cpu) {
 #ifdef __linux__
     cpu_set_t cpuset;
@@ -46,24 +64,63 @@ void set_numa_node(int node) {
 #endif
 }
 
-void* allocate_huge_pages(size_t size) {
+void* allocate_huge_pages(size_t size, bool* huge_pages, bool reserve_only, int numa_node) {
 #ifdef __linux__
+    const int reserve = reserve_only ? MAP_NORESERVE : 0;
     void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
-                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | reserve, -1, 0);
+    bool huge = (ptr != MAP_FAILED);
+    if (huge) bind_to_node(ptr, size, numa_node);
+    
+    // A MAP_NORESERVE hugetlb mapping succeeds even with an empty pool, so
+    // make sure the first page can really be had. Later commits go through
+    // commit_pages, which reports an exhausted pool instead of faulting.
+    if (huge && reserve_only) {
+#ifdef MADV_POPULATE_WRITE
+        const size_t probe = std::min(size, HugePageArena::HUGE_PAGE_SIZE);
+        huge = (madvise(ptr, probe, MADV_POPULATE_WRITE) == 0);
+#else
+        huge = false;  // No way to commit without risking SIGBUS
+#endif
+        if (!huge) munmap(ptr, size);
+    }
     
-    if (ptr == MAP_FAILED) {
-        std::cerr << "Failed to allocate huge pages, falling back to regular pages" 
-                  << std::endl;
+    if (!huge) {
+        // No explicit huge pages configured; callers see it through huge_pages
         ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
-                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                  MAP_PRIVATE | MAP_ANONYMOUS | reserve, -1, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, size, MADV_HUGEPAGE);  // Transparent huge pages instead
+            bind_to_node(ptr, size, numa_node);
+        }
     }
     
+    if (huge_pages) *huge_pages = huge;
     return (ptr == MAP_FAILED) ? nullptr : ptr;
 #else
+    (void)reserve_only;
+    (void)numa_node;
+    if (huge_pages) *huge_pages = false;
     return malloc(size);
 #endif
 }
 
+bool commit_pages(void* ptr, size_t size) noexcept {
+    // ptr must be page aligned (huge page aligned on hugetlb mappings)
+    if (size == 0) return true;
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+    // Fails cleanly where touching a MAP_NORESERVE huge page would SIGBUS
+    if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) return true;
+    if (errno != EINVAL) return false;  // EINVAL: kernel predates it
+#endif
+    uint8_t* bytes = static_cast<uint8_t*>(ptr);
+    for (size_t offset = 0; offset < size; offset += 4096) {
+        bytes[offset] = 0;
+    }
+    bytes[size - 1] = 0;
+    return true;
+}
+
 void deallocate_huge_pages(void* ptr, size_t size) {
 #ifdef __linux__
     munmap(ptr, size);
@@ -73,6 +130,49 @@ void deallocate_huge_pages(void* ptr, size_t size) {
 #endif
 }
 
+HugePageArena::HugePageArena(size_t bytes, int numa_node)
+    : base_(nullptr), capacity_(0), used_(0), committed_(0), numa_node_(numa_node),
+      huge_pages_(false) {
+    
+    capacity_ = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    if (capacity_ == 0) return;
+    
+    base_ = static_cast<uint8_t*>(allocate_huge_pages(capacity_, &huge_pages_, true,
+                                                      numa_node_));
+    if (!base_) {
+        capacity_ = 0;
+    }
+}
+
+HugePageArena::~HugePageArena() {
+    if (base_) {
+        deallocate_huge_pages(base_, capacity_);
+    }
+}
+
+void* HugePageArena::allocate(size_t size, size_t alignment) noexcept {
+    const size_t start = (used_ + alignment - 1) & ~(alignment - 1);
+    if (!base_ || start + size > capacity_) {
+        return nullptr;
+    }
+    
+    // Commit and pre-fault the carved range now rather than on first use,
+    // a whole huge page at a time
+    if (start + size > committed_) {
+        const size_t end = std::min(capacity_,
+                                    (start + size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+        if (!commit_pages(base_ + committed_, end - committed_)) {
+            return nullptr;
+        }
+        committed_ = end;
+    }
+    
+    uint8_t* ptr = base_ + start;
+    
+    used_ = start + size;
+    return ptr;
+}
+
 LatencyStats calculate_latency_stats(const std::vector<uint64_t>& latencies) {
     LatencyStats stats{};
     
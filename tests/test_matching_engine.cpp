@@ -1,6 +1,18 @@
 #include "../include/matching_engine.hpp"
+#include "../include/sharded_engine.hpp"
+#include "../include/mpsc_queue.hpp"
+#include "../include/execution_bus.hpp"
+#include "../include/feed_handler.hpp"
+#include "../include/partitioned_replay.hpp"
 #include "../include/utils.hpp"
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fstream>
 
 using namespace lob;
 
@@ -8,7 +20,7 @@ class MatchingEngineTest : public ::testing::Test {
 protected:
     void SetUp() override {
         EngineConfig config;
-        config.order_pool_size = 10000;
+        config.order_pool_size = 50000;  // Stress test keeps ~20k orders resting
         config.enable_logging = false;
         engine = std::make_unique<MatchingEngine>(config);
         engine->start();
@@ -55,6 +67,96 @@ TEST_F(MatchingEngineTest, OrderMatching) {
     EXPECT_EQ(report.executed_quantity, 50);
 }
 
+TEST_F(MatchingEngineTest, BooksByStockLocate) {
+    OrderBook* aapl = engine->add_book(13, "AAPL", BookConfig{});
+    EXPECT_EQ(engine->get_book(13), aapl);
+    EXPECT_EQ(engine->get_book("AAPL"), aapl);
+    EXPECT_EQ(engine->get_book(14), nullptr);
+    
+    engine->submit_order(13, 1, 0, 100000, 100, Side::SELL, OrderType::LIMIT);
+    engine->submit_order(13, 2, 0, 100000, 40, Side::BUY, OrderType::LIMIT);
+    EXPECT_EQ(engine->get_total_matches(), 1);
+    EXPECT_EQ(aapl->get_total_ask_volume(), 60);
+    
+    // The symbol path reaches the same book
+    engine->cancel_order("AAPL", 1);
+    EXPECT_EQ(aapl->get_order_count(), 0);
+    
+    // Orders for a locate without a directory entry still get a book
+    engine->submit_order(99, 3, 0, 100000, 10, Side::BUY, OrderType::LIMIT);
+    ASSERT_NE(engine->get_book(99), nullptr);
+    EXPECT_EQ(engine->get_book(99)->get_order_count(), 1);
+    engine->cancel_order(99, 3);
+    EXPECT_EQ(engine->get_book(99)->get_order_count(), 0);
+}
+
+TEST_F(MatchingEngineTest, OperationsByReferenceOnly) {
+    engine->submit_order("AAPL", 1, 0, 100000, 100, Side::SELL, OrderType::LIMIT);
+    engine->submit_order("MSFT", 2, 0, 200000, 100, Side::BUY, OrderType::LIMIT);
+    engine->submit_order("MSFT", 3, 0, 199900, 100, Side::BUY, OrderType::LIMIT);
+    OrderBook* aapl = engine->get_book("AAPL");
+    OrderBook* msft = engine->get_book("MSFT");
+    
+    // Partial cancel (ITCH X) and execution (ITCH E) keep the order resting
+    engine->reduce_order(1, 30);
+    EXPECT_EQ(aapl->get_total_ask_volume(), 70);
+    engine->execute_order(1, 20, 5);
+    EXPECT_EQ(aapl->get_total_ask_volume(), 50);
+    
+    ExecutionReport report;
+    ASSERT_TRUE(engine->get_execution_queue().pop(report));
+    EXPECT_EQ(report.order_id, 1);
+    EXPECT_EQ(report.price, 100000);
+    EXPECT_EQ(report.executed_quantity, 20);
+    EXPECT_FALSE(report.is_full_fill);
+    
+    // Executing the rest removes it, as does deleting outright (ITCH D)
+    engine->execute_order(1, 50, 6, 100100);
+    ASSERT_TRUE(engine->get_execution_queue().pop(report));
+    EXPECT_EQ(report.price, 100100);
+    EXPECT_TRUE(report.is_full_fill);
+    EXPECT_EQ(aapl->get_order_count(), 0);
+    EXPECT_EQ(engine->find_order(1), nullptr);
+    
+    engine->delete_order(2);
+    EXPECT_EQ(msft->get_order_count(), 1);
+    EXPECT_EQ(msft->get_best_bid()->price, 199900);
+    
+    // Unknown references are ignored; the wrong symbol does not cancel
+    engine->delete_order(2);
+    engine->cancel_order("AAPL", 3);
+    EXPECT_EQ(msft->get_order_count(), 1);
+    EXPECT_EQ(engine->get_orders_in_use(), 1);
+}
+
+TEST_F(MatchingEngineTest, OrderIdsAreUniqueAcrossSymbols) {
+    engine->submit_order("AAPL", 1, 1, 100000, 100, Side::SELL, OrderType::LIMIT);
+    engine->submit_order("MSFT", 2, 2, 200000, 100, Side::BUY, OrderType::LIMIT);
+    OrderBook* aapl = engine->get_book("AAPL");
+    OrderBook* msft = engine->get_book("MSFT");
+    
+    // Reusing a resting order's id on another symbol is rejected rather
+    // than shadowing it
+    engine->submit_order("MSFT", 1, 3, 199900, 100, Side::BUY, OrderType::LIMIT);
+    EXPECT_EQ(engine->get_rejected_orders(), 1u);
+    EXPECT_EQ(msft->get_order_count(), 1);
+    EXPECT_EQ(engine->find_order(1)->book, aapl);
+    
+    // Filling the MSFT order releases only its own entry
+    engine->submit_order("MSFT", 3, 4, 200000, 100, Side::SELL, OrderType::LIMIT);
+    EXPECT_EQ(msft->get_order_count(), 0);
+    engine->modify_order("AAPL", 1, 60);
+    EXPECT_EQ(aapl->get_total_ask_volume(), 60);
+    engine->cancel_order("AAPL", 1);
+    EXPECT_EQ(aapl->get_order_count(), 0);
+    EXPECT_EQ(engine->get_orders_in_use(), 0);
+    
+    // Once the first order is gone its id is free again
+    engine->submit_order("MSFT", 1, 5, 199900, 100, Side::BUY, OrderType::LIMIT);
+    EXPECT_EQ(msft->get_order_count(), 1);
+    EXPECT_EQ(engine->find_order(1)->book, msft);
+}
+
 TEST_F(MatchingEngineTest, SPSCQueuePerformance) {
     constexpr size_t num_reports = 10000;
     
@@ -88,6 +190,920 @@ TEST_F(MatchingEngineTest, HighVolumeStressTest) {
     EXPECT_GT(engine->get_total_matches(), 0);
 }
 
+TEST_F(MatchingEngineTest, PoolUsageBoundedByLiveOrders) {
+    // Far more messages than pool slots; fills and cancels must recycle
+    for (uint64_t i = 0; i < 50000; ++i) {
+        engine->submit_order("AAPL", i, i, 100000, 100, Side::BUY, OrderType::LIMIT);
+        engine->cancel_order("AAPL", i);
+        engine->submit_order("AAPL", 100000 + i, i, 100000, 100, Side::SELL, OrderType::LIMIT);
+        engine->submit_order("AAPL", 200000 + i, i, 100000, 100, Side::BUY, OrderType::LIMIT);
+    }
+    
+    EXPECT_EQ(engine->get_total_orders(), 150000);
+    EXPECT_EQ(engine->get_total_matches(), 50000);
+    EXPECT_EQ(engine->get_orders_in_use(), engine->get_book("AAPL")->get_order_count());
+}
+
+TEST(OrderPoolTest, LifoReuseAndThreadCache) {
+    OrderPool pool(256);
+    
+    Order* first = pool.allocate();
+    Order* second = pool.allocate();
+    pool.deallocate(first);
+    EXPECT_EQ(pool.allocate(), first);  // Most recently freed comes back first
+    pool.deallocate(first);
+    pool.deallocate(second);
+    EXPECT_EQ(pool.in_use(), 0);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool]() {
+            OrderPool::ThreadCache cache(pool, 8);
+            std::vector<Order*> held;
+            for (int round = 0; round < 10000; ++round) {
+                if (held.size() < 40) {
+                    if (Order* order = cache.allocate()) held.push_back(order);
+                } else {
+                    for (Order* order : held) cache.deallocate(order);
+                    held.clear();
+                }
+            }
+            for (Order* order : held) cache.deallocate(order);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    EXPECT_EQ(pool.in_use(), 0);
+    EXPECT_LE(pool.high_water(), pool.capacity());
+}
+
+TEST(MatchingEngineDirectoryTest, DirectDirectoryMatchesHash) {
+    EngineConfig hash_config;
+    hash_config.order_pool_size = 20000;
+    EngineConfig direct_config = hash_config;
+    direct_config.order_directory = OrderDirectoryType::DIRECT;
+    direct_config.direct_window = 256;  // Force the window to slide
+    
+    auto hash_engine_ptr = std::make_unique<MatchingEngine>(hash_config);
+    auto direct_engine_ptr = std::make_unique<MatchingEngine>(direct_config);
+    MatchingEngine& hash_engine = *hash_engine_ptr;
+    MatchingEngine& direct_engine = *direct_engine_ptr;
+    
+    for (uint64_t i = 0; i < 10000; ++i) {
+        const char* symbol = (i % 3 == 0) ? "MSFT" : "AAPL";
+        Side side = (i % 2 == 0) ? Side::BUY : Side::SELL;
+        uint32_t price = 100000 + (i % 20) * 10 - ((side == Side::BUY) ? 200 : 0);
+        
+        hash_engine.submit_order(symbol, i, i, price, 100, side, OrderType::LIMIT);
+        direct_engine.submit_order(symbol, i, i, price, 100, side, OrderType::LIMIT);
+        
+        if (i >= 500 && i % 4 == 0) {
+            hash_engine.cancel_order(symbol, i - 500);
+            direct_engine.cancel_order(symbol, i - 500);
+        }
+    }
+    
+    EXPECT_EQ(hash_engine.get_total_matches(), direct_engine.get_total_matches());
+    for (const char* symbol : {"AAPL", "MSFT"}) {
+        OrderBook* hash_book = hash_engine.get_book(symbol);
+        OrderBook* direct_book = direct_engine.get_book(symbol);
+        EXPECT_EQ(hash_book->get_order_count(), direct_book->get_order_count());
+        EXPECT_EQ(hash_book->get_total_bid_volume(), direct_book->get_total_bid_volume());
+        EXPECT_EQ(hash_book->get_total_ask_volume(), direct_book->get_total_ask_volume());
+    }
+}
+
+TEST(SymbolDirectoryTest, PacksAndTrimsSymbols) {
+    EXPECT_EQ(pack_symbol("AAPL"), pack_itch_symbol("AAPL    "));
+    EXPECT_EQ(pack_symbol("BRK A"), pack_itch_symbol("BRK A   "));
+    EXPECT_EQ(pack_symbol("GOOGLEXX"), pack_itch_symbol("GOOGLEXX"));
+    EXPECT_EQ(pack_symbol("AAPL  "), pack_symbol("AAPL"));
+    EXPECT_NE(pack_symbol("AAP"), pack_symbol("AAPL"));
+    EXPECT_EQ(pack_symbol(""), 0u);
+    EXPECT_EQ(pack_itch_symbol("        "), 0u);
+    
+    // Too long to pack: rejected rather than truncated onto GOOGLEXX
+    EXPECT_EQ(pack_symbol("GOOGLEXXA"), 0u);
+    EXPECT_EQ(pack_symbol("GOOGLEXXB"), 0u);
+    EngineConfig config;
+    config.order_pool_size = 10;
+    config.use_huge_page_arena = false;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    engine->load_symbols({"GOOGLEXX", "GOOGLEXXA"});
+    engine->submit_order("GOOGLEXXB", 1, 1, 100000, 100, Side::BUY, OrderType::LIMIT);
+    EXPECT_EQ(engine->get_book("GOOGLEXXB"), nullptr);
+    EXPECT_EQ(engine->get_rejected_orders(), 1u);
+    EXPECT_EQ(engine->get_book("GOOGLEXX")->get_order_count(), 0);
+    
+    // A string ending right before a page boundary is read no further
+    alignas(4096) static char page[8192];
+    char* tail = page + 4096 - 3;
+    std::memcpy(tail, "IBM", 4);
+    EXPECT_EQ(pack_symbol(tail), pack_symbol("IBM"));
+}
+
+TEST(SymbolDirectoryTest, FindsEveryLoadedSymbol) {
+    std::vector<SymbolKey> universe;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        char symbol[9];
+        std::snprintf(symbol, sizeof(symbol), "S%05u", i);
+        universe.push_back(pack_symbol(symbol));
+    }
+    
+    SymbolDirectory directory;
+    directory.load(universe);
+    ASSERT_EQ(directory.size(), universe.size());
+    for (uint32_t i = 0; i < universe.size(); ++i) {
+        SymbolId id = directory.find(universe[i]);
+        ASSERT_TRUE(id.valid());
+        EXPECT_EQ(id.index, i);
+    }
+    EXPECT_FALSE(directory.find(pack_symbol("MISSING")).valid());
+    EXPECT_FALSE(directory.find(0).valid());
+    
+    // Intraday additions keep earlier ids stable
+    SymbolId late = directory.insert(pack_symbol("LATE"));
+    EXPECT_EQ(late.index, 10000u);
+    EXPECT_EQ(directory.insert(universe[42]).index, 42u);
+    EXPECT_EQ(directory.find(universe[9999]).index, 9999u);
+    EXPECT_EQ(directory.find(pack_symbol("LATE")).index, 10000u);
+}
+
+TEST_F(MatchingEngineTest, SymbolIdAndStringShareBooks) {
+    engine->load_symbols({"AAPL", "MSFT"});
+    SymbolId msft = engine->get_symbol_id("MSFT");
+    ASSERT_TRUE(msft.valid());
+    ASSERT_NE(engine->get_book(msft), nullptr);
+    EXPECT_EQ(engine->get_book(msft), engine->get_book("MSFT"));
+    EXPECT_FALSE(engine->get_symbol_id("TSLA").valid());
+    
+    engine->submit_order(msft, 1, 0, 200000, 100, Side::SELL, OrderType::LIMIT);
+    engine->submit_order("MSFT", 2, 0, 200000, 100, Side::BUY, OrderType::LIMIT);
+    EXPECT_EQ(engine->get_total_matches(), 1);
+    EXPECT_EQ(engine->get_book(msft)->get_order_count(), 0);
+}
+
+TEST(SPSCQueueTest, BulkAndInPlaceOperationsWrap) {
+    SPSCQueue<uint64_t> queue(6);  // Rounded up to 8
+    EXPECT_EQ(queue.capacity(), 8u);
+    
+    uint64_t next_in = 0, next_out = 0;
+    uint64_t items[5];
+    for (int round = 0; round < 20; ++round) {
+        // Built in place
+        uint64_t* slot = queue.reserve();
+        ASSERT_NE(slot, nullptr);
+        *slot = next_in++;
+        queue.commit();
+        
+        // Bulk push stops at capacity
+        for (auto& item : items) item = next_in++;
+        const size_t pushed = queue.push_n(items, 5);
+        next_in -= 5 - pushed;
+        EXPECT_EQ(queue.size(), pushed + 1 + (round ? 2 : 0));
+        
+        // Read one in place, then take all but two in bulk
+        const uint64_t* head = queue.front();
+        ASSERT_NE(head, nullptr);
+        EXPECT_EQ(*head, next_out++);
+        queue.pop();
+        
+        const size_t take = queue.size() - 2;
+        const size_t popped = queue.pop_n(items, take);
+        ASSERT_EQ(popped, take);
+        for (size_t i = 0; i < popped; ++i) EXPECT_EQ(items[i], next_out++);
+    }
+    
+    // Full ring: all slots usable, then rejected
+    while (queue.push(next_in)) ++next_in;
+    EXPECT_EQ(queue.size(), 8u);
+    EXPECT_EQ(queue.reserve(), nullptr);
+    EXPECT_EQ(queue.push_n(items, 5), 0u);
+    
+    uint64_t value;
+    while (queue.pop(value)) EXPECT_EQ(value, next_out++);
+    EXPECT_EQ(next_out, next_in);
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(MPSCQueueTest, ProducersKeepTheirOwnOrder) {
+    constexpr size_t num_producers = 4;
+    constexpr uint64_t per_producer = 50000;
+    auto queue = std::make_unique<MPSCQueue<EngineCommand, 1024>>();
+    
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p] {
+            EngineCommand command{};
+            command.stock_locate = static_cast<uint16_t>(p);
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                command.order_id = i;
+                while (!queue->push(command)) std::this_thread::yield();
+            }
+        });
+    }
+    
+    std::vector<uint64_t> next(num_producers, 0);
+    EngineCommand command;
+    for (size_t received = 0; received < num_producers * per_producer;) {
+        if (!queue->pop(command)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_LT(command.stock_locate, num_producers);
+        ASSERT_EQ(command.order_id, next[command.stock_locate]++);
+        ++received;
+    }
+    for (auto& t : producers) t.join();
+    EXPECT_FALSE(queue->pop(command));
+}
+
+TEST(MPSCQueueTest, FullRingRejectsThenRecovers) {
+    MPSCQueue<int, 4> queue;
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.push(i));
+    EXPECT_FALSE(queue.push(4));
+    
+    int value = -1;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(queue.push(4));
+    for (int expected = 1; expected <= 4; ++expected) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(MatchingEngineBatchTest, BatchMatchesOneByOne) {
+    EngineConfig config;
+    config.order_pool_size = 20000;
+    config.use_huge_page_arena = false;
+    auto batched = std::make_unique<MatchingEngine>(config);
+    auto single = std::make_unique<MatchingEngine>(config);
+    
+    std::vector<EngineCommand> commands;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        EngineCommand command{};
+        command.order_id = i + 1;
+        command.stock_locate = static_cast<uint16_t>(i % 3);
+        command.timestamp = i;
+        if (i >= 40 && i % 4 == 0) {
+            command.type = (i % 8 == 0) ? CommandType::CANCEL : CommandType::EXECUTE;
+            command.order_id = i - 39;
+            command.quantity = 50;
+        } else {
+            command.type = CommandType::ADD;
+            command.side = (i % 2) ? Side::BUY : Side::SELL;
+            command.order_type = OrderType::LIMIT;
+            command.price = 100000 + (i % 11) * 10 - ((i % 2) ? 40 : 0);
+            command.quantity = 100;
+        }
+        commands.push_back(command);
+    }
+    
+    // Uneven packet sizes, including ones shorter than the lookahead
+    ExecutionReport report;
+    for (size_t i = 0, packet = 1; i < commands.size(); i += packet, packet = packet % 37 + 1) {
+        const size_t count = std::min(packet, commands.size() - i);
+        batched->submit_batch(&commands[i], count);
+        for (size_t j = 0; j < count; ++j) single->apply(commands[i + j]);
+        while (batched->get_execution_queue().pop(report)) {}
+        while (single->get_execution_queue().pop(report)) {}
+    }
+    
+    EXPECT_EQ(batched->get_total_orders(), single->get_total_orders());
+    EXPECT_EQ(batched->get_total_matches(), single->get_total_matches());
+    EXPECT_EQ(batched->get_orders_in_use(), single->get_orders_in_use());
+    for (uint16_t locate = 0; locate < 3; ++locate) {
+        EXPECT_EQ(batched->get_book(locate)->get_total_bid_volume(),
+                  single->get_book(locate)->get_total_bid_volume());
+        EXPECT_EQ(batched->get_book(locate)->get_total_ask_volume(),
+                  single->get_book(locate)->get_total_ask_volume());
+    }
+}
+
+TEST(ShardedEngineTest, MatchesSingleEngineResults) {
+    ShardedEngineConfig config;
+    config.num_shards = 3;
+    config.engine_config.order_pool_size = 20000;
+    config.engine_config.use_huge_page_arena = false;
+    auto sharded = std::make_unique<ShardedEngine>(config);
+    auto single = std::make_unique<MatchingEngine>(config.engine_config);
+    
+    for (uint64_t i = 0; i < 20000; ++i) {
+        EngineCommand command{};
+        command.stock_locate = static_cast<uint16_t>(i % 7);
+        command.order_id = i + 1;
+        command.timestamp = i;
+        // Commands carry the locate of the order they refer to
+        if (i >= 100 && i % 5 == 0) {
+            command.type = CommandType::CANCEL;
+            command.order_id = i - 99;
+            command.stock_locate = static_cast<uint16_t>((i - 100) % 7);
+        } else if (i >= 100 && i % 5 == 1) {
+            command.type = CommandType::REDUCE;
+            command.order_id = i - 50;
+            command.stock_locate = static_cast<uint16_t>((i - 51) % 7);
+            command.quantity = 10;
+        } else {
+            command.type = CommandType::ADD;
+            command.side = (i % 2) ? Side::BUY : Side::SELL;
+            command.order_type = OrderType::LIMIT;
+            command.price = 100000 + (i % 13) * 10 - ((i % 2) ? 60 : 0);
+            command.quantity = 100;
+        }
+        sharded->submit(command);
+        single->apply(command);
+        
+        // Keep the execution rings from filling up
+        if (i % 1000 == 0) sharded->poll_executions([](const ExecutionReport&) {});
+    }
+    sharded->drain();
+    
+    size_t reports = 0;
+    sharded->poll_executions([&reports](const ExecutionReport&) { ++reports; });
+    
+    EXPECT_EQ(sharded->get_total_orders(), single->get_total_orders());
+    EXPECT_EQ(sharded->get_total_matches(), single->get_total_matches());
+    for (uint16_t locate = 0; locate < 7; ++locate) {
+        OrderBook* expected = single->get_book(locate);
+        MatchingEngine& shard = sharded->shard(sharded->shard_of(locate));
+        OrderBook* actual = shard.get_book(locate);
+        ASSERT_NE(actual, nullptr);
+        EXPECT_EQ(actual->get_order_count(), expected->get_order_count());
+        EXPECT_EQ(actual->get_total_bid_volume(), expected->get_total_bid_volume());
+        EXPECT_EQ(actual->get_total_ask_volume(), expected->get_total_ask_volume());
+    }
+    
+    // Each locate lives on exactly one shard
+    const uint16_t locate = 0;
+    EXPECT_EQ(sharded->shard((sharded->shard_of(locate) + 1) % 3).get_book(locate), nullptr);
+}
+
+TEST(ShardedEngineTest, ShardWorkersOverrideTheEngineEventLoop) {
+    // A shard's worker is the only thread that may apply commands and
+    // publish fills, so an event loop asked for in engine_config is not run
+    ShardedEngineConfig config;
+    config.num_shards = 2;
+    config.engine_config.order_pool_size = 4000;
+    config.engine_config.use_huge_page_arena = false;
+    config.engine_config.run_event_loop = true;
+    auto sharded = std::make_unique<ShardedEngine>(config);
+    
+    for (size_t shard = 0; shard < 2; ++shard) {
+        EXPECT_FALSE(sharded->shard(shard).get_config().run_event_loop);
+        EXPECT_FALSE(sharded->shard(shard).enqueue(EngineCommand{}));
+    }
+    
+    // Resting bids then crossing asks on both shards: every fill arrives once
+    uint64_t order_id = 1;
+    for (uint16_t locate = 0; locate < 2; ++locate) {
+        for (int side = 0; side < 2; ++side) {
+            for (int i = 0; i < 1000; ++i) {
+                EngineCommand command{};
+                command.type = CommandType::ADD;
+                command.stock_locate = locate;
+                command.order_id = order_id++;
+                command.side = side ? Side::SELL : Side::BUY;
+                command.order_type = OrderType::LIMIT;
+                command.price = 100000;
+                command.quantity = 100;
+                sharded->submit(command);
+            }
+        }
+    }
+    sharded->drain();
+    
+    size_t reports = 0;
+    sharded->poll_executions([&reports](const ExecutionReport&) { ++reports; });
+    EXPECT_EQ(sharded->get_total_matches(), 2000u);
+    EXPECT_EQ(reports, 2000u);
+}
+
+// Rest one-lot asks, then sweep them with one buy: more fills than the
+// execution ring holds. With run_event_loop the sweep can be posted.
+static std::unique_ptr<MatchingEngine> sweep_engine(BackpressurePolicy policy,
+                                                    uint32_t fills,
+                                                    bool run_event_loop = false) {
+    EngineConfig config;
+    config.order_pool_size = fills + 1;
+    config.use_huge_page_arena = false;
+    config.execution_backpressure = policy;
+    config.run_event_loop = run_event_loop;
+    config.idle_strategy = IdleStrategy::PARK;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    
+    const uint16_t locate = 1;
+    for (uint32_t i = 0; i < fills; ++i) {
+        engine->submit_order(locate, i + 1, i, 100000, 1, Side::SELL, OrderType::LIMIT);
+    }
+    return engine;
+}
+
+TEST(MatchingEngineEventLoopTest, EveryIdleStrategyAppliesPostedCommands) {
+    EngineConfig config;
+    config.order_pool_size = 10000;
+    config.use_huge_page_arena = false;
+    EXPECT_FALSE(std::make_unique<MatchingEngine>(config)->enqueue(EngineCommand{}));
+    
+    for (IdleStrategy strategy : {IdleStrategy::BUSY_SPIN, IdleStrategy::PAUSE,
+                                  IdleStrategy::BACKOFF, IdleStrategy::PARK}) {
+        EngineConfig loop_config = config;
+        loop_config.run_event_loop = true;
+        loop_config.idle_strategy = strategy;
+        auto looped = std::make_unique<MatchingEngine>(loop_config);
+        auto direct = std::make_unique<MatchingEngine>(config);
+        looped->start();
+        
+        for (uint64_t i = 0; i < 5000; ++i) {
+            EngineCommand command{};
+            command.stock_locate = static_cast<uint16_t>(i % 3);
+            command.order_id = i + 1;
+            command.timestamp = i;
+            if (i >= 10 && i % 4 == 0) {
+                command.type = CommandType::CANCEL;
+                command.order_id = i - 9;
+            } else {
+                command.type = CommandType::ADD;
+                command.side = (i % 2) ? Side::BUY : Side::SELL;
+                command.order_type = OrderType::LIMIT;
+                command.price = 100000 + (i % 11) * 10 - ((i % 2) ? 50 : 0);
+                command.quantity = 100;
+            }
+            while (!looped->enqueue(command)) std::this_thread::yield();
+            direct->apply(command);
+            
+            // Let the loop go idle now and then so parking gets exercised
+            if (i % 1000 == 999) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        looped->stop();
+        
+        EXPECT_EQ(looped->get_total_orders(), direct->get_total_orders());
+        EXPECT_EQ(looped->get_total_matches(), direct->get_total_matches());
+        for (uint16_t locate = 0; locate < 3; ++locate) {
+            ASSERT_NE(looped->get_book(locate), nullptr);
+            EXPECT_EQ(looped->get_book(locate)->get_order_count(),
+                      direct->get_book(locate)->get_order_count());
+        }
+    }
+}
+
+TEST(MatchingEngineMirrorTest, AppliesEventsWithoutMatching) {
+    EngineConfig config;
+    config.order_pool_size = 100;
+    config.use_huge_page_arena = false;
+    config.mirror_mode = true;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    const uint16_t locate = 2;
+    
+    // A locked book stays locked; nothing is invented
+    engine->submit_order(locate, 1, 1, 100000, 100, Side::BUY, OrderType::LIMIT);
+    engine->submit_order(locate, 2, 2, 100000, 100, Side::SELL, OrderType::LIMIT);
+    engine->submit_order(locate, 3, 3, 99900, 100, Side::SELL, OrderType::LIMIT);
+    OrderBook* book = engine->get_book(locate);
+    EXPECT_EQ(book->get_order_count(), 3u);
+    EXPECT_EQ(engine->get_total_matches(), 0u);
+    EXPECT_TRUE(engine->get_execution_queue().empty());
+    
+    // The venue's own events still apply
+    engine->execute_order(1, 40, 4);
+    engine->reduce_order(2, 10);
+    engine->replace_order(3, 4, 5, 100100, 70);
+    EXPECT_EQ(engine->get_total_matches(), 1u);
+    EXPECT_EQ(book->get_total_bid_volume(), 60u);
+    EXPECT_EQ(book->get_total_ask_volume(), 90u + 70u);
+    EXPECT_EQ(book->get_best_ask()->price, 100000u);
+    
+    engine->delete_order(1);
+    EXPECT_EQ(book->get_best_bid(), nullptr);
+    EXPECT_EQ(engine->get_orders_in_use(), 2u);
+}
+
+TEST(ExecutionBackpressureTest, DropCountsEveryLostFill) {
+    constexpr uint32_t fills = 70000;
+    auto engine = sweep_engine(BackpressurePolicy::DROP, fills);
+    const uint16_t locate = 1;
+    engine->submit_order(locate, fills + 1, fills, 100000, fills, Side::BUY, OrderType::LIMIT);
+    
+    // Only delivered fills count as matches
+    const size_t queued = engine->get_execution_queue().size();
+    EXPECT_EQ(engine->get_total_matches(), queued);
+    EXPECT_GT(engine->get_dropped_reports(), 0u);
+    EXPECT_EQ(queued + engine->get_dropped_reports(), fills);
+}
+
+TEST(ExecutionBackpressureTest, SpillKeepsEveryFillInOrder) {
+    constexpr uint32_t fills = 70000;
+    auto engine = sweep_engine(BackpressurePolicy::SPILL, fills);
+    const uint16_t locate = 1;
+    engine->submit_order(locate, fills + 1, fills, 100000, fills, Side::BUY, OrderType::LIMIT);
+    EXPECT_GT(engine->get_spilled_reports(), 0u);
+    
+    // Match ids count up from 1 in fill order
+    uint64_t expected_id = 1;
+    ExecutionReport report;
+    auto& queue = engine->get_execution_queue();
+    do {
+        while (queue.pop(report)) {
+            ASSERT_EQ(report.match_id, expected_id);
+            ++expected_id;
+        }
+    } while (engine->flush_executions() != 0 || !queue.empty());
+    
+    EXPECT_EQ(expected_id - 1, fills);
+    EXPECT_EQ(engine->get_dropped_reports(), 0u);
+}
+
+TEST(ExecutionBackpressureTest, DrainThreadDeliversEveryFill) {
+    constexpr uint32_t fills = 70000;
+    auto engine = sweep_engine(BackpressurePolicy::YIELD, fills);
+    
+    std::vector<uint64_t> seen;
+    seen.reserve(fills);
+    ASSERT_TRUE(engine->start_execution_drain(
+        [&seen](const ExecutionReport* reports, size_t count) {
+            for (size_t i = 0; i < count; ++i) seen.push_back(reports[i].match_id);
+        }));
+    EXPECT_FALSE(engine->start_execution_drain(
+        [](const ExecutionReport*, size_t) {}));
+    
+    const uint16_t locate = 1;
+    engine->submit_order(locate, fills + 1, fills, 100000, fills, Side::BUY, OrderType::LIMIT);
+    engine->stop_execution_drain();
+    
+    ASSERT_EQ(seen.size(), fills);
+    for (uint32_t i = 0; i < fills; ++i) ASSERT_EQ(seen[i], i + 1u);
+}
+
+TEST(ExecutionBackpressureTest, ParkingLoopKeepsFlushingTheSpill) {
+    constexpr uint32_t fills = 70000;
+    auto engine = sweep_engine(BackpressurePolicy::SPILL, fills, true);
+    engine->start();
+    
+    EngineCommand sweep{};
+    sweep.type = CommandType::ADD;
+    sweep.stock_locate = 1;
+    sweep.order_id = fills + 1;
+    sweep.price = 100000;
+    sweep.quantity = fills;
+    sweep.side = Side::BUY;
+    sweep.order_type = OrderType::LIMIT;
+    ASSERT_TRUE(engine->enqueue(sweep));
+    while (engine->get_total_matches() != fills) std::this_thread::yield();
+    EXPECT_GT(engine->get_spilled_reports(), 0u);
+    
+    // Nothing else is posted: the idle loop alone must move the spill
+    // into the ring as the drain makes room
+    std::atomic<uint64_t> seen{0};
+    engine->start_execution_drain([&seen](const ExecutionReport*, size_t count) {
+        seen.fetch_add(count, std::memory_order_relaxed);
+    });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (seen.load() != fills && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(seen.load(), fills);
+    
+    engine->stop_execution_drain();  // Stops the loop first
+    EXPECT_EQ(seen.load(), fills);
+}
+
+TEST(ExecutionBusTest, ReadersSeeEveryFillFromTheDrainSink) {
+    constexpr uint32_t fills = 300;
+    auto writer = ExecutionBusWriter::create(nullptr, 1000);
+    ASSERT_NE(writer, nullptr);
+    EXPECT_EQ(writer->capacity(), 1024u);
+    auto live = ExecutionBusReader::open(writer->fd());
+    ASSERT_NE(live, nullptr);
+    
+    auto engine = sweep_engine(BackpressurePolicy::SPILL, fills);
+    ExecutionBusWriter* bus = writer.get();
+    engine->start_execution_drain([bus](const ExecutionReport* reports, size_t count) {
+        bus->publish(reports, count);
+    });
+    const uint16_t locate = 1;
+    engine->submit_order(locate, fills + 1, fills, 100000, fills, Side::BUY, OrderType::LIMIT);
+    engine->stop_execution_drain();
+    EXPECT_EQ(writer->published(), fills);
+    
+    // A reader attached later can still start from the oldest report held
+    auto late = ExecutionBusReader::open(writer->fd(), true);
+    auto late_live = ExecutionBusReader::open(writer->fd());
+    ASSERT_NE(late, nullptr);
+    ASSERT_NE(late_live, nullptr);
+    
+    for (ExecutionBusReader* reader : {live.get(), late.get()}) {
+        uint64_t expected_id = 1;
+        EXPECT_EQ(reader->lag(), fills);
+        reader->poll([&expected_id](const ExecutionReport& report) {
+            EXPECT_EQ(report.match_id, expected_id++);
+            EXPECT_EQ(report.executed_quantity, 1u);
+        });
+        EXPECT_EQ(expected_id - 1, fills);
+        EXPECT_EQ(reader->lost(), 0u);
+    }
+    EXPECT_EQ(late_live->poll([](const ExecutionReport&) {}), 0u);
+}
+
+TEST(ExecutionBusTest, LappedReaderDetectsOverrun) {
+    const std::string name = "/lob_bus_test_" + std::to_string(getpid());
+    auto writer = ExecutionBusWriter::create(name.c_str(), 8);
+    ASSERT_NE(writer, nullptr);
+    auto reader = ExecutionBusReader::open(name.c_str());
+    ASSERT_NE(reader, nullptr);
+    
+    for (uint64_t i = 0; i < 20; ++i) {
+        writer->publish(ExecutionReport(1, i, i, 100000, 100, Side::BUY, false));
+    }
+    
+    // Reports 0..12 were overwritten; 13..19 are still held
+    ExecutionReport report;
+    EXPECT_EQ(reader->read(report), BusReadStatus::OVERRUN);
+    EXPECT_EQ(reader->lost(), 13u);
+    for (uint64_t i = 13; i < 20; ++i) {
+        ASSERT_EQ(reader->read(report), BusReadStatus::OK);
+        EXPECT_EQ(report.match_id, i);
+    }
+    EXPECT_EQ(reader->read(report), BusReadStatus::EMPTY);
+    EXPECT_EQ(reader->lag(), 0u);
+}
+
+// Length-prefixed ITCH message: 2-byte big-endian length, type, body
+template<typename Body>
+static void append_itch(std::vector<uint8_t>& out, char type, const Body& body) {
+    const uint16_t length = __builtin_bswap16(static_cast<uint16_t>(sizeof(Body) + 1));
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&body);
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&length),
+               reinterpret_cast<const uint8_t*>(&length) + sizeof(length));
+    out.push_back(static_cast<uint8_t>(type));
+    out.insert(out.end(), bytes, bytes + sizeof(Body));
+}
+
+static std::vector<uint8_t> make_itch_session(uint16_t locate = 7,
+                                              const char* symbol = "MSFT    ",
+                                              uint64_t first_ref = 1) {
+    std::vector<uint8_t> out;
+    ITCHStockDirectory directory{};
+    directory.stock_locate = __builtin_bswap16(locate);
+    std::memcpy(directory.stock, symbol, 8);
+    append_itch(out, 'R', directory);
+    
+    for (uint64_t ref = first_ref; ref < first_ref + 1000; ++ref) {
+        ITCHAddOrder add{};
+        add.stock_locate = __builtin_bswap16(locate);
+        add.order_ref_num = __builtin_bswap64(ref);
+        add.buy_sell_indicator = (ref % 2) ? 'B' : 'S';
+        add.shares = __builtin_bswap32(100);
+        add.price = __builtin_bswap32((ref % 2) ? 1000000 - ref * 10 : 1010000 + ref * 10);
+        append_itch(out, 'A', add);
+        
+        if (ref % 3 == 0) {
+            ITCHOrderDelete del{};
+            del.stock_locate = __builtin_bswap16(locate);
+            del.order_ref_num = __builtin_bswap64(ref - 1);
+            append_itch(out, 'D', del);
+        } else if (ref % 5 == 0) {
+            ITCHOrderExecuted executed{};
+            executed.stock_locate = __builtin_bswap16(locate);
+            executed.order_ref_num = __builtin_bswap64(ref);
+            executed.executed_shares = __builtin_bswap32(40);
+            append_itch(out, 'E', executed);
+        }
+    }
+    return out;
+}
+
+TEST(FeedHandlerTest, MappedAndPipelinedReplayMatchStreamReplay) {
+    const std::vector<uint8_t> session = make_itch_session();
+    const std::string path = "/tmp/lob_feed_test_" + std::to_string(getpid()) + ".itch";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(session.data()), session.size());
+        // Truncated trailing message is ignored by both paths
+        file.write(reinterpret_cast<const char*>(session.data()), 10);
+    }
+    
+    EngineConfig config;
+    config.order_pool_size = 2000;
+    config.use_huge_page_arena = false;
+    uint64_t messages[3];
+    size_t resting[3];
+    uint64_t bid_volume[3];
+    for (ReplayMode mode : {ReplayMode::STREAM, ReplayMode::MMAP, ReplayMode::PIPELINED}) {
+        auto engine = std::make_unique<MatchingEngine>(config);
+        FeedHandler feed(*engine);
+        feed.replay_itch_file(path, mode);
+        
+        const uint16_t locate = 7;
+        OrderBook* book = engine->get_book(locate);
+        ASSERT_NE(book, nullptr);
+        EXPECT_EQ(engine->get_book("MSFT"), book);
+        const int i = static_cast<int>(mode);
+        messages[i] = feed.get_messages_processed();
+        resting[i] = book->get_order_count();
+        bid_volume[i] = book->get_total_bid_volume();
+    }
+    std::remove(path.c_str());
+    
+    EXPECT_EQ(messages[0], 1000u + 1000u / 3 + (1000u / 5 - 1000u / 15) + 1);
+    for (int i = 1; i < 3; ++i) {
+        EXPECT_EQ(messages[i], messages[0]);
+        EXPECT_EQ(resting[i], resting[0]);
+        EXPECT_EQ(bid_volume[i], bid_volume[0]);
+    }
+    EXPECT_EQ(resting[0], 1000u - 1000u / 3);
+}
+
+TEST(FeedHandlerTest, BufferReplayStopsAtTruncatedMessage) {
+    const std::vector<uint8_t> session = make_itch_session();
+    EngineConfig config;
+    config.order_pool_size = 2000;
+    config.use_huge_page_arena = false;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    FeedHandler feed(*engine);
+    
+    // Directory message, then all but the last byte of the first add
+    const size_t directory_bytes = 2 + 1 + sizeof(ITCHStockDirectory);
+    const size_t add_bytes = 2 + 1 + sizeof(ITCHAddOrder);
+    EXPECT_EQ(feed.replay_itch_buffer(session.data(), directory_bytes + add_bytes - 1),
+              directory_bytes);
+    EXPECT_EQ(feed.get_messages_processed(), 1u);
+    EXPECT_EQ(feed.replay_itch_buffer(session.data() + directory_bytes, add_bytes), add_bytes);
+    EXPECT_EQ(engine->get_total_orders(), 1u);
+}
+
+TEST(FeedHandlerTest, IndexedReplayStopsAtBadOffset) {
+    const std::vector<uint8_t> session = make_itch_session();
+    EngineConfig config;
+    config.order_pool_size = 2000;
+    config.use_huge_page_arena = false;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    FeedHandler feed(*engine);
+    
+    // Directory, first add, then offsets past the end and into the last
+    // message, which cannot hold a whole one
+    const uint64_t directory_bytes = 2 + 1 + sizeof(ITCHStockDirectory);
+    const uint64_t offsets[] = {0, directory_bytes, session.size() + 4096, session.size() - 2};
+    EXPECT_EQ(feed.replay_itch_messages(session.data(), session.size(), offsets, 4), 2u);
+    EXPECT_EQ(feed.replay_itch_messages(session.data(), session.size(), offsets + 3, 1), 0u);
+    EXPECT_EQ(feed.get_messages_processed(), 2u);
+    EXPECT_EQ(engine->get_total_orders(), 1u);
+}
+
+TEST(PartitionedReplayTest, RoutedAndIndexedReplayMatchOneEngine) {
+    // Three symbols, two partitions: locates 7 and 9 share partition 1
+    const uint16_t locates[] = {7, 8, 9};
+    std::vector<uint8_t> day = make_itch_session(7, "MSFT    ", 1);
+    for (const auto& session : {make_itch_session(8, "AAPL    ", 30001),
+                                make_itch_session(9, "NVDA    ", 60001)}) {
+        day.insert(day.end(), session.begin(), session.end());
+    }
+    const std::string path = "/tmp/lob_partition_test_" + std::to_string(getpid());
+    const std::string itch_path = path + ".itch";
+    const std::string index_path = path + ".idx";
+    {
+        std::ofstream file(itch_path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(day.data()), day.size());
+    }
+    
+    EngineConfig config;
+    config.order_pool_size = 4000;
+    config.use_huge_page_arena = false;
+    config.execution_backpressure = BackpressurePolicy::DROP;
+    auto reference = std::make_unique<MatchingEngine>(config);
+    FeedHandler feed(*reference);
+    feed.replay_itch_file(itch_path);
+    
+    PartitionedReplayConfig partitioned_config;
+    partitioned_config.num_partitions = 2;
+    partitioned_config.engine_config = config;
+    ASSERT_TRUE(PartitionedReplay::build_index(itch_path, 2, index_path));
+    
+    for (bool indexed : {false, true}) {
+        PartitionedReplay replay(partitioned_config);
+        ASSERT_TRUE(replay.replay(itch_path, indexed ? index_path : ""));
+        
+        for (uint16_t locate : locates) {
+            const size_t owner = replay.partition_of(locate);
+            OrderBook* book = replay.engine(owner).get_book(locate);
+            ASSERT_NE(book, nullptr);
+            EXPECT_EQ(replay.engine(1 - owner).get_book(locate), nullptr);
+            EXPECT_EQ(book->get_order_count(), reference->get_book(locate)->get_order_count());
+            EXPECT_EQ(book->get_total_bid_volume(),
+                      reference->get_book(locate)->get_total_bid_volume());
+        }
+        
+        const ReplayStats& stats = replay.get_stats();
+        EXPECT_EQ(stats.messages, feed.get_messages_processed());
+        EXPECT_EQ(stats.total_orders, reference->get_total_orders());
+        EXPECT_EQ(stats.resting_orders, reference->get_orders_in_use());
+        EXPECT_EQ(replay.get_partition_stats(0).messages + replay.get_partition_stats(1).messages,
+                  stats.messages);
+    }
+    
+    // An index for another partition count is ignored, not trusted
+    PartitionedReplayConfig three = partitioned_config;
+    three.num_partitions = 3;
+    PartitionedReplay replay(three);
+    ASSERT_TRUE(replay.replay(itch_path, index_path));
+    EXPECT_EQ(replay.get_stats().messages, feed.get_messages_processed());
+    
+    std::remove(itch_path.c_str());
+    std::remove(index_path.c_str());
+}
+
+static void set_itch_timestamp(uint8_t (&field)[6], uint64_t nanos) {
+    for (int i = 5; i >= 0; --i, nanos >>= 8) field[i] = static_cast<uint8_t>(nanos);
+}
+
+TEST(FeedHandlerTest, DecodesOrderLifecycleAndTrades) {
+    EngineConfig config;
+    config.order_pool_size = 100;
+    config.use_huge_page_arena = false;
+    auto engine = std::make_unique<MatchingEngine>(config);
+    FeedHandler feed(*engine);
+    const uint64_t nanos = 34200000000123ULL;  // 09:30:00.000000123
+    std::vector<uint8_t> session;
+    
+    ITCHStockDirectory directory{};
+    directory.stock_locate = __builtin_bswap16(3);
+    std::memcpy(directory.stock, "AAPL    ", 8);
+    append_itch(session, 'R', directory);
+    
+    ITCHAddOrderMPID bid{};
+    bid.stock_locate = __builtin_bswap16(3);
+    set_itch_timestamp(bid.timestamp, nanos);
+    bid.order_ref_num = __builtin_bswap64(1);
+    bid.buy_sell_indicator = 'B';
+    bid.shares = __builtin_bswap32(100);
+    bid.price = __builtin_bswap32(1000000);
+    std::memcpy(bid.attribution, "GSCO", 4);
+    append_itch(session, 'F', bid);
+    
+    ITCHAddOrder ask{};
+    ask.stock_locate = __builtin_bswap16(3);
+    ask.order_ref_num = __builtin_bswap64(2);
+    ask.buy_sell_indicator = 'S';
+    ask.shares = __builtin_bswap32(100);
+    ask.price = __builtin_bswap32(1010000);
+    append_itch(session, 'A', ask);
+    
+    ITCHOrderExecutedWithPrice executed{};
+    set_itch_timestamp(executed.timestamp, nanos + 1);
+    executed.order_ref_num = __builtin_bswap64(1);
+    executed.executed_shares = __builtin_bswap32(30);
+    executed.printable = 'Y';
+    executed.execution_price = __builtin_bswap32(999900);
+    append_itch(session, 'C', executed);
+    
+    ITCHOrderReplace replace{};
+    set_itch_timestamp(replace.timestamp, nanos + 2);
+    replace.original_order_ref_num = __builtin_bswap64(2);
+    replace.new_order_ref_num = __builtin_bswap64(5);
+    replace.shares = __builtin_bswap32(50);
+    replace.price = __builtin_bswap32(1005000);
+    append_itch(session, 'U', replace);
+    
+    ITCHTrade trade{};
+    trade.shares = __builtin_bswap32(200);
+    append_itch(session, 'P', trade);
+    ITCHCrossTrade cross{};
+    cross.shares = __builtin_bswap64(5000);
+    append_itch(session, 'Q', cross);
+    append_itch(session, 'B', ITCHBrokenTrade{});
+    append_itch(session, 'Z', ITCHBrokenTrade{});   // Unknown type
+    append_itch(session, 'U', ITCHOrderDelete{});   // Too short for 'U', ignored
+    
+    EXPECT_EQ(feed.replay_itch_buffer(session.data(), session.size()), session.size());
+    
+    const uint16_t locate = 3;
+    OrderBook* book = engine->get_book(locate);
+    ASSERT_NE(book, nullptr);
+    EXPECT_EQ(book->get_total_bid_volume(), 70u);
+    EXPECT_EQ(book->get_total_ask_volume(), 50u);
+    EXPECT_EQ(engine->find_order(2), nullptr);
+    ASSERT_NE(engine->find_order(5), nullptr);
+    EXPECT_EQ(engine->find_order(5)->price, 1005000u);
+    EXPECT_EQ(engine->find_order(5)->timestamp, nanos + 2);
+    EXPECT_EQ(engine->find_order(1)->timestamp, nanos);
+    
+    ExecutionReport report;
+    ASSERT_TRUE(engine->get_execution_queue().pop(report));
+    EXPECT_EQ(report.order_id, 1u);
+    EXPECT_EQ(report.price, 999900u);
+    EXPECT_EQ(report.executed_quantity, 30u);
+    EXPECT_EQ(report.timestamp, nanos + 1);
+    
+    const TradeStats& trades = feed.get_trade_stats();
+    EXPECT_EQ(trades.trades, 1u);
+    EXPECT_EQ(trades.trade_volume, 200u);
+    EXPECT_EQ(trades.cross_trades, 1u);
+    EXPECT_EQ(trades.cross_volume, 5000u);
+    EXPECT_EQ(trades.broken_trades, 1u);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,7 +1,13 @@
 #include "../include/order_book.hpp"
 #include "../include/utils.hpp"
+#include "../include/level_pool.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
 
 using namespace lob;
 
@@ -90,6 +96,32 @@ TEST_F(OrderBookTest, PriceTimePriority) {
     EXPECT_EQ(reports[0].order_id, 3); // Aggressive order ID
 }
 
+TEST_F(OrderBookTest, MatchIntoSink) {
+    Order sell1(1, get_timestamp_ns(), 100000, 50, Side::SELL, OrderType::LIMIT);
+    Order sell2(2, get_timestamp_ns(), 100100, 50, Side::SELL, OrderType::LIMIT);
+    book->add_order(&sell1);
+    book->add_order(&sell2);
+    
+    // Fixed-size sink, nothing allocated on the match path
+    ExecutionReport fills[4];
+    size_t fill_count = 0;
+    Order buy(3, get_timestamp_ns(), 100100, 80, Side::BUY, OrderType::LIMIT);
+    book->match_order(&buy, [&](const ExecutionReport& report) {
+        fills[fill_count++] = report;
+    });
+    
+    ASSERT_EQ(fill_count, 2);
+    EXPECT_EQ(fills[0].price, 100000);
+    EXPECT_EQ(fills[0].executed_quantity, 50);
+    EXPECT_FALSE(fills[0].is_full_fill);
+    EXPECT_EQ(fills[1].price, 100100);
+    EXPECT_EQ(fills[1].executed_quantity, 30);
+    EXPECT_TRUE(fills[1].is_full_fill);
+    EXPECT_EQ(buy.remaining_quantity, 0);
+    EXPECT_EQ(book->get_best_ask()->price, 100100);
+    EXPECT_EQ(book->get_total_ask_volume(), 20);
+}
+
 TEST_F(OrderBookTest, CancelOrder) {
     Order order(1, get_timestamp_ns(), 100000, 100, Side::BUY, OrderType::LIMIT);
     book->add_order(&order);
@@ -125,6 +157,375 @@ TEST_F(OrderBookTest, MultiplePriceLevels) {
     EXPECT_EQ(book->get_total_bid_volume(), 300);
 }
 
+TEST_F(OrderBookTest, TrendingPricesKeepOrdersAttached) {
+    // Sequential prices used to degenerate the tree into a list, and
+    // interior removals used to move levels out from under their orders
+    constexpr size_t num_levels = 2000;
+    std::vector<Order> orders;
+    orders.reserve(num_levels * 2);
+    
+    for (size_t i = 0; i < num_levels; ++i) {
+        uint32_t price = 100000 + static_cast<uint32_t>(i) * 100;
+        orders.emplace_back(i * 2, i, price, 100, Side::BUY, OrderType::LIMIT);
+        orders.emplace_back(i * 2 + 1, i, price, 100, Side::BUY, OrderType::LIMIT);
+    }
+    for (auto& order : orders) {
+        book->add_order(&order);
+    }
+    
+    // Empty every third level in a scattered order
+    std::mt19937 rng(7);
+    std::vector<size_t> victims;
+    for (size_t i = 0; i < num_levels; i += 3) victims.push_back(i);
+    std::shuffle(victims.begin(), victims.end(), rng);
+    for (size_t level : victims) {
+        book->cancel_order(level * 2);
+        book->cancel_order(level * 2 + 1);
+    }
+    
+    size_t remaining_levels = num_levels - victims.size();
+    EXPECT_EQ(book->get_order_count(), remaining_levels * 2);
+    EXPECT_EQ(book->get_total_bid_volume(), remaining_levels * 200);
+    EXPECT_EQ(book->get_best_bid()->price, 100000 + (num_levels - 1) * 100);
+    
+    // Remaining orders must still point at live levels
+    for (size_t i = 0; i < num_levels; ++i) {
+        if (i % 3 == 0) continue;
+        ASSERT_NE(orders[i * 2].parent_level, nullptr);
+        EXPECT_EQ(orders[i * 2].parent_level->price, orders[i * 2].price);
+    }
+    
+    // Sweep the whole side
+    Order sell(num_levels * 2, 0, 0, static_cast<uint32_t>(remaining_levels * 200),
+               Side::SELL, OrderType::LIMIT);
+    auto reports = book->match_order(&sell);
+    
+    EXPECT_EQ(reports.size(), remaining_levels * 2);
+    EXPECT_EQ(sell.remaining_quantity, 0);
+    EXPECT_EQ(book->get_best_bid(), nullptr);
+    EXPECT_EQ(book->get_total_bid_volume(), 0);
+}
+
+TEST_F(OrderBookTest, LadderMatchesTreeResults) {
+    BookConfig ladder_config;
+    ladder_config.price_index = PriceIndexType::LADDER;
+    ladder_config.tick_size = 100;
+    ladder_config.ladder_size = 64;  // Small window to force recentering
+    
+    OrderBook tree_book;
+    OrderBook ladder_book(ladder_config);
+    
+    constexpr size_t num_ops = 20000;
+    std::vector<Order> tree_orders(num_ops);
+    std::vector<Order> ladder_orders(num_ops);
+    std::vector<uint64_t> live;
+    
+    std::mt19937 rng(42);
+    uint32_t mid = 1000000;
+    
+    for (size_t i = 0; i < num_ops; ++i) {
+        // Drift the mid so the ladder window has to follow the book
+        mid += (rng() % 3) * 100 - 100;
+        
+        if (!live.empty() && rng() % 3 == 0) {
+            size_t pick = rng() % live.size();
+            tree_book.cancel_order(live[pick]);
+            ladder_book.cancel_order(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            Side side = (rng() % 2) ? Side::BUY : Side::SELL;
+            int32_t offset = static_cast<int32_t>(rng() % 100) * 100 - 2000;
+            uint32_t price = mid + offset + ((rng() % 20 == 0) ? 37 : 0);  // Some off-tick prices
+            uint32_t qty = 100 + rng() % 500;
+            
+            tree_orders[i] = Order(i, i, price, qty, side, OrderType::LIMIT);
+            ladder_orders[i] = Order(i, i, price, qty, side, OrderType::LIMIT);
+            
+            auto tree_reports = tree_book.match_order(&tree_orders[i]);
+            auto ladder_reports = ladder_book.match_order(&ladder_orders[i]);
+            
+            ASSERT_EQ(tree_reports.size(), ladder_reports.size());
+            for (size_t r = 0; r < tree_reports.size(); ++r) {
+                EXPECT_EQ(tree_reports[r].price, ladder_reports[r].price);
+                EXPECT_EQ(tree_reports[r].executed_quantity, ladder_reports[r].executed_quantity);
+            }
+            
+            if (tree_orders[i].remaining_quantity > 0) {
+                tree_book.add_order(&tree_orders[i]);
+                ladder_book.add_order(&ladder_orders[i]);
+                live.push_back(i);
+            }
+        }
+        
+        ASSERT_EQ(tree_book.get_best_bid() == nullptr, ladder_book.get_best_bid() == nullptr);
+        ASSERT_EQ(tree_book.get_best_ask() == nullptr, ladder_book.get_best_ask() == nullptr);
+        if (tree_book.get_best_bid()) {
+            ASSERT_EQ(tree_book.get_best_bid()->price, ladder_book.get_best_bid()->price);
+        }
+        if (tree_book.get_best_ask()) {
+            ASSERT_EQ(tree_book.get_best_ask()->price, ladder_book.get_best_ask()->price);
+        }
+    }
+    
+    EXPECT_EQ(tree_book.get_total_bid_volume(), ladder_book.get_total_bid_volume());
+    EXPECT_EQ(tree_book.get_total_ask_volume(), ladder_book.get_total_ask_volume());
+    EXPECT_EQ(tree_book.get_order_count(), ladder_book.get_order_count());
+}
+
+TEST(OccupancyBitmapTest, FindNextAndPrevMatchLinearScan) {
+    constexpr size_t num_bits = 64 * 64 * 3 + 17;  // Spans several groups
+    OccupancyBitmap bitmap;
+    bitmap.init(num_bits);
+    std::vector<bool> reference(num_bits, false);
+    
+    std::mt19937 rng(3);
+    for (size_t round = 0; round < 2000; ++round) {
+        size_t i = rng() % num_bits;
+        if (reference[i]) {
+            bitmap.clear(i);
+        } else {
+            bitmap.set(i);
+        }
+        reference[i] = !reference[i];
+        
+        size_t probe = rng() % num_bits;
+        size_t next = OccupancyBitmap::npos;
+        for (size_t j = probe; j < num_bits; ++j) {
+            if (reference[j]) { next = j; break; }
+        }
+        size_t prev = OccupancyBitmap::npos;
+        for (size_t j = probe + 1; j-- > 0;) {
+            if (reference[j]) { prev = j; break; }
+        }
+        
+        ASSERT_EQ(bitmap.find_next(probe), next);
+        ASSERT_EQ(bitmap.find_prev(probe), prev);
+    }
+}
+
+TEST(FlatHashMapTest, MatchesUnorderedMap) {
+    FlatHashMap<uint64_t> flat(16);  // Start small to exercise growth
+    std::unordered_map<uint64_t, uint64_t> reference;
+    
+    std::mt19937_64 rng(11);
+    for (size_t round = 0; round < 50000; ++round) {
+        uint64_t key = rng() % 4096;  // Dense keys make long probe clusters
+        switch (rng() % 3) {
+            case 0:
+                flat.insert(key, round);
+                reference[key] = round;
+                break;
+            case 1: {
+                uint64_t value = 0;
+                bool removed = flat.extract(key, value);
+                auto it = reference.find(key);
+                ASSERT_EQ(removed, it != reference.end());
+                if (removed) {
+                    EXPECT_EQ(value, it->second);
+                    reference.erase(it);
+                }
+                break;
+            }
+            default: {
+                const uint64_t* value = flat.find(key);
+                auto it = reference.find(key);
+                ASSERT_EQ(value != nullptr, it != reference.end());
+                if (value) {
+                    EXPECT_EQ(*value, it->second);
+                }
+                break;
+            }
+        }
+        ASSERT_EQ(flat.size(), reference.size());
+    }
+    
+    for (const auto& entry : reference) {
+        ASSERT_NE(flat.find(entry.first), nullptr);
+    }
+}
+
+TEST(DirectOrderTableTest, SlidingWindowKeepsStragglers) {
+    DirectOrderTable<uint64_t> table(1024);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    
+    // Mostly sequential ids with a long tail of old ids left resting
+    std::mt19937_64 rng(5);
+    uint64_t next_id = 1;
+    std::vector<uint64_t> live;
+    for (size_t round = 0; round < 100000; ++round) {
+        if (live.empty() || rng() % 5 < 3) {
+            uint64_t id = next_id;
+            next_id += 1 + rng() % 3;
+            table.insert(id, id * 7);
+            reference[id] = id * 7;
+            live.push_back(id);
+        } else {
+            // Cancel recent ids more often than old ones
+            size_t pick = (rng() % 4 == 0) ? rng() % live.size()
+                                          : live.size() - 1 - rng() % std::min<size_t>(live.size(), 64);
+            uint64_t value = 0;
+            ASSERT_TRUE(table.extract(live[pick], value));
+            EXPECT_EQ(value, live[pick] * 7);
+            reference.erase(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    
+    EXPECT_EQ(table.size(), reference.size());
+    EXPECT_GT(table.fallback_size(), 0);
+    for (const auto& entry : reference) {
+        const uint64_t* value = table.find(entry.first);
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, entry.second);
+    }
+    EXPECT_EQ(table.find(next_id + 5), nullptr);
+}
+
+TEST(DirectOrderTableTest, SlideEvictsABoundedAmountPerInsert) {
+    const size_t window = 1 << 16;
+    DirectOrderTable<uint64_t> table(window);
+    for (uint64_t id = 1; id < window / 2; ++id) table.insert(id, id);
+    
+    // A jump far past the window evicts at most one step's worth now; the
+    // new id and the rest of the window stay reachable meanwhile
+    const uint64_t far = 10 * window;
+    table.insert(far, far);
+    EXPECT_LE(table.fallback_size(), DirectOrderTable<uint64_t>::MAX_EVICT_PER_INSERT + 1);
+    
+    // Following ids carry the eviction forward until the window catches up
+    for (uint64_t id = far + 1; id < far + window; ++id) {
+        const size_t before = table.fallback_size();
+        table.insert(id, id);
+        EXPECT_LE(table.fallback_size() - before,
+                  DirectOrderTable<uint64_t>::MAX_EVICT_PER_INSERT + 1);
+    }
+    for (uint64_t id = 1; id < window / 2; ++id) {
+        const uint64_t* value = table.find(id);
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, id);
+    }
+    for (uint64_t id = far; id < far + window; ++id) {
+        uint64_t value = 0;
+        ASSERT_TRUE(table.extract(id, value));
+        EXPECT_EQ(value, id);
+    }
+    EXPECT_EQ(table.size(), window / 2 - 1);
+}
+
+TEST(HugePageArenaTest, CarvesAlignedBlocksUntilExhausted) {
+    HugePageArena arena(HugePageArena::HUGE_PAGE_SIZE);
+    ASSERT_EQ(arena.capacity(), HugePageArena::HUGE_PAGE_SIZE);
+    
+    void* first = arena.allocate(100);
+    void* second = arena.allocate(100);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 64, 0);
+    EXPECT_EQ(arena.allocate(HugePageArena::HUGE_PAGE_SIZE), nullptr);
+    
+    // A book carves level chunks from the arena on first use
+    BookConfig config;
+    config.level_chunk_size = 1024;
+    config.level_arena = &arena;
+    size_t used_before = arena.used();
+    OrderBook arena_book(config);
+    EXPECT_EQ(arena.used(), used_before);
+    
+    Order order(1, 0, 100000, 100, Side::BUY, OrderType::LIMIT);
+    arena_book.add_order(&order);
+    EXPECT_EQ(arena_book.get_best_bid()->price, 100000);
+    EXPECT_GE(arena.used() - used_before, 1024 * sizeof(PriceLevel));
+}
+
+TEST(HugePageArenaTest, ReservesWithoutCommitting) {
+    // More address space than the machine has memory: reserving it is
+    // free, and only what is carved gets backed
+    const size_t memory = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) *
+                          static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t reservation = std::min(4 * memory, size_t{64} << 30) &
+                               ~(HugePageArena::HUGE_PAGE_SIZE - 1);
+    HugePageArena arena(reservation);
+    if (arena.capacity() == 0) {
+        GTEST_SKIP() << "Cannot reserve " << (reservation >> 20) << " MB of address space here";
+    }
+    ASSERT_EQ(arena.capacity(), reservation);
+    
+    auto* block = static_cast<uint8_t*>(arena.allocate(HugePageArena::HUGE_PAGE_SIZE));
+    ASSERT_NE(block, nullptr);
+    block[0] = 1;
+    block[HugePageArena::HUGE_PAGE_SIZE - 1] = 2;
+    EXPECT_EQ(arena.used(), HugePageArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(arena.committed(), HugePageArena::HUGE_PAGE_SIZE);
+    
+    ASSERT_NE(arena.allocate(100), nullptr);
+    EXPECT_EQ(arena.committed(), 2 * HugePageArena::HUGE_PAGE_SIZE);
+}
+
+TEST(PriceLevelPoolTest, LevelsAreRecycledAcrossBooks) {
+    PriceLevelPool pool(64);
+    EXPECT_EQ(pool.chunk_count(), 0);
+    
+    BookConfig config;
+    config.level_pool = &pool;
+    
+    {
+        OrderBook book_a(config);
+        OrderBook book_b(config);
+        
+        // Far more distinct prices over time than the pool ever holds at once
+        for (uint32_t round = 0; round < 1000; ++round) {
+            Order bid(round * 2, 0, 100000 + round * 100, 10, Side::BUY, OrderType::LIMIT);
+            Order ask(round * 2 + 1, 0, 900000 + round * 100, 10, Side::SELL, OrderType::LIMIT);
+            book_a.add_order(&bid);
+            book_b.add_order(&ask);
+            EXPECT_EQ(pool.in_use(), 2);
+            
+            Order buy(1000000 + round, 0, ask.price, 10, Side::BUY, OrderType::LIMIT);
+            book_b.match_order(&buy);
+            book_a.cancel_order(bid.order_id);
+            EXPECT_EQ(pool.in_use(), 0);
+        }
+        EXPECT_EQ(pool.chunk_count(), 1);
+        
+        // Levels left resting go back to the shared pool with their book
+        Order resting(5, 0, 100000, 10, Side::BUY, OrderType::LIMIT);
+        book_a.add_order(&resting);
+        EXPECT_EQ(pool.in_use(), 1);
+    }
+    EXPECT_EQ(pool.in_use(), 0);
+}
+
+TEST_F(OrderBookTest, LadderSweepsSeveralLevels) {
+    BookConfig config;
+    config.price_index = PriceIndexType::LADDER;
+    OrderBook ladder_book(config);
+    
+    // Asks spread across several bitmap words
+    std::vector<Order> asks;
+    asks.reserve(10);
+    for (uint32_t i = 0; i < 10; ++i) {
+        asks.emplace_back(i, i, 1000000 + i * 100 * 97, 100, Side::SELL, OrderType::LIMIT);
+    }
+    for (auto& ask : asks) {
+        ladder_book.add_order(&ask);
+    }
+    
+    Order buy(100, 0, 1000000 + 5 * 100 * 97, 550, Side::BUY, OrderType::LIMIT);
+    auto reports = ladder_book.match_order(&buy);
+    
+    EXPECT_EQ(reports.size(), 6);
+    EXPECT_EQ(buy.remaining_quantity, 0);
+    ASSERT_NE(ladder_book.get_best_ask(), nullptr);
+    EXPECT_EQ(ladder_book.get_best_ask()->price, 1000000 + 5 * 100 * 97);
+    EXPECT_EQ(ladder_book.get_best_ask()->total_volume, 50);
+    
+    // Cancelling the touch level moves straight to the next one
+    ladder_book.cancel_order(5);
+    EXPECT_EQ(ladder_book.get_best_ask()->price, 1000000 + 6 * 100 * 97);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();